@@ -1,38 +1,30 @@
-#ifndef BINARYTREE_H
-#define BINARYTREE_H
-
-
-
-class binaryTree {
-private:
-    struct node {
-        int possible_num [9]{};  //possible numbers
-        int count;             //count of valid numbers
-        node *left;
-        node *right;
-
-        node();
-        void remove_possible_num(int num);
-        bool has_possible_num(int num) const;
-        int get_next_possible_num() const;
-    };
-
-    node *root;
-
-public:
-    binaryTree();
-    ~binaryTree();
-
-    void initialize(); //fill tree with initial numbers
-    void remove(int num) const; //updates the possible nums after adding a num to the tree
-    bool contain(int num) const; //checks if the num is still possible
-    bool isEmpty() const; //check if the cell has any possible nums
-    int next_possible_num() const; //returns the next possible num to try
-    void print() const; //prints the remaining possible nums
-
-};
-
-
-
-#endif
-
+#ifndef BINARYTREE_H
+#define BINARYTREE_H
+
+
+
+// Candidate set of one cell (digits 1..9). Historically a heap-allocated tree
+// node with an array of numbers; it is now a value type holding a single
+// 16-bit mask (bit num-1 set while num is possible), so creating one per
+// search node costs no allocation and every operation is a few bit ops.
+class binaryTree {
+private:
+    static const unsigned short ALL = 0x1FF;
+
+    unsigned short possible;    //possible numbers
+
+public:
+    binaryTree() : possible(0) {}
+
+    void initialize() { possible = ALL; } //fill tree with initial numbers
+    void remove(int num) { if (num >= 1 && num <= 9) possible &= static_cast<unsigned short>(~(1u << (num - 1))); } //updates the possible nums after adding a num to the tree
+    bool contain(int num) const { return num >= 1 && num <= 9 && ((possible >> (num - 1)) & 1); } //checks if the num is still possible
+    bool isEmpty() const { return possible == 0; } //check if the cell has any possible nums
+    int next_possible_num() const { return possible ? __builtin_ctz(possible) + 1 : -1; } //returns the next possible num to try (smallest first)
+    void print() const; //prints the remaining possible nums
+
+};
+
+
+
+#endif
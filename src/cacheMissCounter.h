@@ -0,0 +1,28 @@
+#ifndef CACHEMISSCOUNTER_H
+#define CACHEMISSCOUNTER_H
+
+// Hardware cache-miss counter for the calling thread, read through
+// perf_event_open on Linux. Kernels that forbid it (perf_event_paranoid,
+// containers, other platforms) leave the counter unavailable and stop()
+// returns -1 so callers can report "n/a".
+class CacheMissCounter {
+public:
+    CacheMissCounter();
+    ~CacheMissCounter();
+
+    bool isAvailable() const;
+
+    // Reset and enable the counter
+    void start();
+
+    // Disable the counter and return the misses since start(), -1 if unavailable
+    long long stop();
+
+private:
+    int fd;
+
+    CacheMissCounter(const CacheMissCounter&);
+    CacheMissCounter& operator=(const CacheMissCounter&);
+};
+
+#endif
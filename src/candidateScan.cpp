@@ -0,0 +1,243 @@
+#include "candidateScan.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CANDIDATESCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef CandidateScan<3> Scan9;
+typedef void (*ScanKernel)(const std::uint16_t* rowMask, const std::uint16_t* colMask,
+                           const std::uint16_t* boxMask, const int* values, Scan9& scan);
+
+const std::uint16_t FULL = BoardTraits<3>::FULL_MASK;
+
+// Single / blocked flags of the 81 cells, gathered in registers row by row
+// and written to the scan once at the end
+struct CellFlags {
+    std::uint64_t singles[2] = {0, 0};
+    std::uint64_t blocked[2] = {0, 0};
+
+    // The 9 flags of row start at bit row * 9 and may straddle the two words
+    void addRow(int row, unsigned rowSingles, unsigned rowBlocked) {
+        int first = row * 9;
+        singles[first / 64] |= static_cast<std::uint64_t>(rowSingles) << (first % 64);
+        blocked[first / 64] |= static_cast<std::uint64_t>(rowBlocked) << (first % 64);
+        if (first % 64 > 64 - 9) {
+            singles[1] |= static_cast<std::uint64_t>(rowSingles) >> (64 - first % 64);
+            blocked[1] |= static_cast<std::uint64_t>(rowBlocked) >> (64 - first % 64);
+        }
+    }
+
+    void store(Scan9& scan) const {
+        scan.singles[0] = singles[0];
+        scan.singles[1] = singles[1];
+        scan.blocked[0] = blocked[0];
+        scan.blocked[1] = blocked[1];
+    }
+};
+
+void scanScalar(const std::uint16_t* rowMask, const std::uint16_t* colMask,
+                const std::uint16_t* boxMask, const int* values, Scan9& scan) {
+    CellFlags flags;
+    for (int row = 0; row < 9; row++) {
+        unsigned singles = 0;
+        unsigned blocked = 0;
+        for (int col = 0; col < 9; col++) {
+            int cell = row * 9 + col;
+            std::uint16_t mask = static_cast<std::uint16_t>(~(rowMask[row] | colMask[col] | boxMask[BoardTraits<3>::boxOf(row, col)]) & FULL);
+            scan.masks[cell] = mask;
+            if (values[cell] == 0) {
+                singles |= static_cast<unsigned>(mask != 0 && (mask & (mask - 1)) == 0) << col;
+                blocked |= static_cast<unsigned>(mask == 0) << col;
+            }
+        }
+        flags.addRow(row, singles, blocked);
+    }
+    flags.store(scan);
+}
+
+#ifdef CANDIDATESCAN_X86
+
+// One row per pass in two 8-lane registers: columns 0-7, then column 8 in
+// lane 0 of the second (the padding lanes are forced to no candidates)
+void scanSse2(const std::uint16_t* rowMask, const std::uint16_t* colMask,
+              const std::uint16_t* boxMask, const int* values, Scan9& scan) {
+    CellFlags flags;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i full = _mm_set1_epi16(static_cast<short>(FULL));
+    const __m128i colsLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colMask));
+    const __m128i colsHigh = _mm_or_si128(_mm_cvtsi32_si128(colMask[8]), _mm_setr_epi16(0, -1, -1, -1, -1, -1, -1, -1));
+
+    for (int band = 0; band < 3; band++) {
+        const std::uint16_t* boxes = boxMask + band * 3;
+        __m128i boxLow = _mm_setr_epi16(boxes[0], boxes[0], boxes[0], boxes[1], boxes[1], boxes[1], boxes[2], boxes[2]);
+        __m128i boxHigh = _mm_cvtsi32_si128(boxes[2]);
+
+        for (int row = band * 3; row < band * 3 + 3; row++) {
+            __m128i used = _mm_set1_epi16(static_cast<short>(rowMask[row]));
+            __m128i low = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(used, colsLow), boxLow), full);
+            __m128i high = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(used, colsHigh), boxHigh), full);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(scan.masks + row * 9), low);
+            scan.masks[row * 9 + 8] = static_cast<std::uint16_t>(_mm_cvtsi128_si32(high));
+
+            // A mask has at most one bit when mask & (mask - 1) == 0
+            __m128i noneLow = _mm_cmpeq_epi16(low, zero);
+            __m128i noneHigh = _mm_cmpeq_epi16(high, zero);
+            __m128i oneLow = _mm_andnot_si128(noneLow, _mm_cmpeq_epi16(_mm_and_si128(low, _mm_sub_epi16(low, one)), zero));
+            __m128i oneHigh = _mm_andnot_si128(noneHigh, _mm_cmpeq_epi16(_mm_and_si128(high, _mm_sub_epi16(high, one)), zero));
+            unsigned singles = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(oneLow, oneHigh))) & 0x1FF;
+            unsigned blocked = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(noneLow, noneHigh))) & 0x1FF;
+
+            const int* rowValues = values + row * 9;
+            unsigned empty = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rowValues)), zero))))
+                           | static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rowValues + 4)), zero)))) << 4
+                           | static_cast<unsigned>(rowValues[8] == 0) << 8;
+
+            flags.addRow(row, singles & empty, blocked & empty);
+        }
+    }
+    flags.store(scan);
+}
+
+// One row per pass in a single 16-lane register (lanes 9-15 are padding)
+__attribute__((target("avx2")))
+void scanAvx2(const std::uint16_t* rowMask, const std::uint16_t* colMask,
+              const std::uint16_t* boxMask, const int* values, Scan9& scan) {
+    CellFlags flags;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i full = _mm256_set1_epi16(static_cast<short>(FULL));
+    const __m128i colsHigh = _mm_or_si128(_mm_cvtsi32_si128(colMask[8]), _mm_setr_epi16(0, -1, -1, -1, -1, -1, -1, -1));
+    const __m256i cols = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colMask))), colsHigh, 1);
+
+    for (int band = 0; band < 3; band++) {
+        const std::uint16_t* boxes = boxMask + band * 3;
+        __m128i boxLow = _mm_setr_epi16(boxes[0], boxes[0], boxes[0], boxes[1], boxes[1], boxes[1], boxes[2], boxes[2]);
+        __m256i box = _mm256_inserti128_si256(_mm256_castsi128_si256(boxLow), _mm_cvtsi32_si128(boxes[2]), 1);
+
+        for (int row = band * 3; row < band * 3 + 3; row++) {
+            __m256i used = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi16(static_cast<short>(rowMask[row])), cols), box);
+            __m256i candidates = _mm256_andnot_si256(used, full);
+
+            // Rows are stored in order, so each 16-lane store only spills
+            // into the next row, which overwrites it; the last row goes
+            // through a buffer to stay inside masks[]
+            if (row < 8) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(scan.masks + row * 9), candidates);
+            } else {
+                alignas(32) std::uint16_t last[16];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(last), candidates);
+                std::memcpy(scan.masks + row * 9, last, 9 * sizeof(std::uint16_t));
+            }
+
+            __m256i none = _mm256_cmpeq_epi16(candidates, zero);
+            __m256i single = _mm256_andnot_si256(none, _mm256_cmpeq_epi16(_mm256_and_si256(candidates, _mm256_sub_epi16(candidates, one)), zero));
+
+            // packs works per 128-bit half: lanes 0-7 land in bits 0-7 and
+            // lanes 8-15 in bits 16-23 of the byte mask
+            unsigned singleBits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_packs_epi16(single, zero)));
+            unsigned noneBits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_packs_epi16(none, zero)));
+            unsigned singles = (singleBits & 0xFF) | ((singleBits >> 8) & 0x100);
+            unsigned blocked = (noneBits & 0xFF) | ((noneBits >> 8) & 0x100);
+
+            const int* rowValues = values + row * 9;
+            __m256i emptyCells = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowValues)), zero);
+            unsigned empty = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(emptyCells)))
+                           | static_cast<unsigned>(rowValues[8] == 0) << 8;
+
+            flags.addRow(row, singles & empty, blocked & empty);
+        }
+    }
+    flags.store(scan);
+}
+
+#endif
+
+struct KernelEntry {
+    const char* name;
+    ScanKernel scan;
+    bool (*supported)();
+};
+
+bool alwaysSupported() {
+    return true;
+}
+
+#ifdef CANDIDATESCAN_X86
+bool avx2Supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+// Fastest first
+const KernelEntry kernels[] = {
+#ifdef CANDIDATESCAN_X86
+    {"avx2", scanAvx2, avx2Supported},
+    {"sse2", scanSse2, alwaysSupported},  // Part of the x86-64 baseline
+#endif
+    {"scalar", scanScalar, alwaysSupported},
+};
+
+const KernelEntry* selectKernel() {
+    for (const KernelEntry& entry : kernels) {
+        if (entry.supported()) {
+            return &entry;
+        }
+    }
+    return &kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+}
+
+const KernelEntry* activeKernel = selectKernel();
+
+} // namespace
+
+template <int Order>
+void scanCandidates(const BasicGraph<Order>& graph, CandidateScan<Order>& scan) {
+    typedef BoardTraits<Order> Traits;
+    const int* values = graph.getValues();
+
+    for (int w = 0; w < CandidateScan<Order>::WORDS; w++) {
+        scan.singles[w] = 0;
+        scan.blocked[w] = 0;
+    }
+
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        typename Traits::Mask mask = graph.getCandidateMaskAt(cell);
+        scan.masks[cell] = mask;
+        if (values[cell] == 0) {
+            std::uint64_t bit = std::uint64_t(1) << (cell % 64);
+            if (mask == 0) {
+                scan.blocked[cell / 64] |= bit;
+            } else if ((mask & (mask - 1)) == 0) {
+                scan.singles[cell / 64] |= bit;
+            }
+        }
+    }
+}
+
+template <>
+void scanCandidates<3>(const BasicGraph<3>& graph, CandidateScan<3>& scan) {
+    activeKernel->scan(graph.getRowMasks(), graph.getColMasks(), graph.getBoxMasks(), graph.getValues(), scan);
+}
+
+template void scanCandidates<4>(const BasicGraph<4>& graph, CandidateScan<4>& scan);
+template void scanCandidates<5>(const BasicGraph<5>& graph, CandidateScan<5>& scan);
+
+const char* getCandidateKernel() {
+    return activeKernel->name;
+}
+
+bool setCandidateKernel(const std::string& name) {
+    for (const KernelEntry& entry : kernels) {
+        if (name == entry.name && entry.supported()) {
+            activeKernel = &entry;
+            return true;
+        }
+    }
+    return false;
+}
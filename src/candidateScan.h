@@ -0,0 +1,45 @@
+#ifndef CANDIDATESCAN_H
+#define CANDIDATESCAN_H
+
+#include <cstdint>
+#include <string>
+#include "graph.h"
+
+// Candidates of every cell of a board, computed in one pass as
+// ~(row | column | box) from the graph's occupancy masks.
+template <int Order>
+struct CandidateScan {
+    typedef BoardTraits<Order> Traits;
+    typedef typename Traits::Mask Mask;
+
+    static const int WORDS = (Traits::CELLS + 63) / 64;
+
+    Mask masks[Traits::CELLS];      // Candidates of each cell; only meaningful for empty cells
+    std::uint64_t singles[WORDS];   // Bit per empty cell with exactly one candidate (naked single)
+    std::uint64_t blocked[WORDS];   // Bit per empty cell with no candidate left
+
+    bool hasBlockedCell() const {
+        for (int w = 0; w < WORDS; w++) {
+            if (blocked[w] != 0) return true;
+        }
+        return false;
+    }
+};
+
+// Fill scan from the current state of graph. The 9x9 board runs a SIMD
+// kernel (AVX2 or SSE2) picked at runtime from the CPU features, with a
+// scalar fallback; larger boards always use the scalar loop.
+template <int Order>
+void scanCandidates(const BasicGraph<Order>& graph, CandidateScan<Order>& scan);
+
+template <>
+void scanCandidates<3>(const BasicGraph<3>& graph, CandidateScan<3>& scan);
+
+// Name of the 9x9 kernel in use: "avx2", "sse2" or "scalar"
+const char* getCandidateKernel();
+
+// Switch the 9x9 kernel (for the benchmark); false if the CPU lacks it.
+// Not safe while other threads are solving.
+bool setCandidateKernel(const std::string& name);
+
+#endif
@@ -0,0 +1,104 @@
+#include "cellQueue.h"
+
+template <int Order>
+BasicCellQueue<Order>::BasicCellQueue(BasicGraph<Order>& sudokuGraph) : graph(sudokuGraph), size(0) {
+    for (int k = 0; k <= Traits::SIDE; k++) {
+        head[k] = -1;
+    }
+
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        cells[cell] = graph.getNodeByPosition(cell / Traits::SIDE, cell % Traits::SIDE);
+        queued[cell] = false;
+    }
+
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        if (graph.getValueAt(cell) == 0) {
+            insert(cell);
+        }
+    }
+}
+
+template <int Order>
+bool BasicCellQueue<Order>::isEmpty() const {
+    return size == 0;
+}
+
+template <int Order>
+int BasicCellQueue<Order>::peekMostConstrained() const {
+    for (int k = 0; k <= Traits::SIDE; k++) {
+        if (head[k] != -1) {
+            return head[k];
+        }
+    }
+    return -1;
+}
+
+template <int Order>
+BasicNode<Order>* BasicCellQueue<Order>::getCell(int cell) const {
+    return cells[cell];
+}
+
+template <int Order>
+int BasicCellQueue<Order>::candidateCount(int cell) const {
+    return countCandidates(graph.getCandidateMaskAt(cell));
+}
+
+template <int Order>
+void BasicCellQueue<Order>::insert(int cell) {
+    int k = candidateCount(cell);
+    key[cell] = k;
+    prev[cell] = -1;
+    next[cell] = head[k];
+    if (head[k] != -1) {
+        prev[head[k]] = cell;
+    }
+    head[k] = cell;
+    queued[cell] = true;
+    size++;
+}
+
+template <int Order>
+void BasicCellQueue<Order>::remove(int cell) {
+    if (prev[cell] != -1) {
+        next[prev[cell]] = next[cell];
+    } else {
+        head[key[cell]] = next[cell];
+    }
+    if (next[cell] != -1) {
+        prev[next[cell]] = prev[cell];
+    }
+    queued[cell] = false;
+    size--;
+}
+
+// Re-bucket the queued peers whose candidate count changed
+template <int Order>
+void BasicCellQueue<Order>::updatePeers(int cell) {
+    for (int k = 0; k < Traits::PEERS; k++) {
+        int peer = boardTopology<Order>.peers[cell][k];
+        if (queued[peer] && candidateCount(peer) != key[peer]) {
+            remove(peer);
+            insert(peer);
+        }
+    }
+}
+
+template <int Order>
+void BasicCellQueue<Order>::assigned(int cell) {
+    if (queued[cell]) {
+        remove(cell);
+    }
+    updatePeers(cell);
+}
+
+template <int Order>
+void BasicCellQueue<Order>::unassigned(int cell) {
+    if (!queued[cell]) {
+        insert(cell);
+    }
+    updatePeers(cell);
+}
+
+template class BasicCellQueue<3>;
+template class BasicCellQueue<4>;
+template class BasicCellQueue<5>;
@@ -0,0 +1,45 @@
+#ifndef CELLQUEUE_H
+#define CELLQUEUE_H
+
+#include "graph.h"
+
+// Priority structure for MRV (minimum remaining values) branching.
+//
+// Empty cells are kept in buckets by their number of candidates (0..SIDE),
+// each bucket an intrusive doubly linked list over the cell indices. Placing
+// or clearing a value only re-buckets the cell and its peers, so picking the
+// most constrained cell is a scan over the bucket heads instead of all cells.
+template <int Order>
+class BasicCellQueue {
+public:
+    typedef BoardTraits<Order> Traits;
+
+    explicit BasicCellQueue(BasicGraph<Order>& sudokuGraph);
+
+    bool isEmpty() const;
+    int peekMostConstrained() const;    // Cell index (row * SIDE + col), -1 if empty
+    BasicNode<Order>* getCell(int cell) const;
+
+    // Call after the value of cell was set / cleared in the graph
+    void assigned(int cell);
+    void unassigned(int cell);
+
+private:
+    BasicGraph<Order>& graph;
+    BasicNode<Order>* cells[Traits::CELLS];
+    int key[Traits::CELLS];     // Candidate count of each queued cell
+    int prev[Traits::CELLS];
+    int next[Traits::CELLS];
+    bool queued[Traits::CELLS];
+    int head[Traits::SIDE + 1]; // First cell of each bucket, -1 if empty
+    int size;
+
+    int candidateCount(int cell) const;
+    void insert(int cell);
+    void remove(int cell);
+    void updatePeers(int cell);
+};
+
+typedef BasicCellQueue<3> CellQueue;
+
+#endif
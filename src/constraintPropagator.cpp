@@ -0,0 +1,270 @@
+#include "constraintPropagator.h"
+
+// The units of the grid: rows, columns, then boxes
+template <int Order>
+struct BoardUnits {
+    typedef BoardTraits<Order> Traits;
+    typename Traits::CellIndex cells[Traits::UNITS][Traits::SIDE];
+};
+
+template <int Order>
+static constexpr BoardUnits<Order> makeBoardUnits() {
+    typedef BoardTraits<Order> Traits;
+    typedef typename Traits::CellIndex CellIndex;
+    const int side = Traits::SIDE;
+    BoardUnits<Order> units{};
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            int boxRow = (i / Order) * Order + j / Order;
+            int boxCol = (i % Order) * Order + j % Order;
+            units.cells[i][j] = static_cast<CellIndex>(i * side + j);
+            units.cells[side + i][j] = static_cast<CellIndex>(j * side + i);
+            units.cells[2 * side + i][j] = static_cast<CellIndex>(boxRow * side + boxCol);
+        }
+    }
+    return units;
+}
+
+template <int Order>
+static constexpr BoardUnits<Order> boardUnits = makeBoardUnits<Order>();
+
+template <int Order>
+BasicConstraintPropagator<Order>::BasicConstraintPropagator(BasicGraph<Order>& sudokuGraph)
+    : graph(sudokuGraph), complete(true), trailSize(0), queueHead(0), queueTail(0), guesses(0), searchNodes(0), limits(nullptr) {
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        if (graph.getNodeByPosition(cell / Traits::SIDE, cell % Traits::SIDE) == nullptr) {
+            complete = false;
+        }
+    }
+}
+
+template <int Order>
+long long BasicConstraintPropagator<Order>::getGuesses() const {
+    return guesses;
+}
+
+template <int Order>
+long long BasicConstraintPropagator<Order>::getSearchNodes() const {
+    return searchNodes;
+}
+
+// Seed the domains of the empty cells with their candidates from one scan of
+// the whole board and assign its naked singles. The givens are still queued:
+// their peers already exclude them, so this only catches conflicting givens.
+template <int Order>
+bool BasicConstraintPropagator<Order>::initialize() {
+    trailSize = 0;
+    queueHead = 0;
+    queueTail = 0;
+
+    if (!complete) {
+        return false;
+    }
+
+    CandidateScan<Order> scan;
+    scanCandidates(graph, scan);
+    if (scan.hasBlockedCell()) {
+        return false;
+    }
+
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        int value = graph.getValueAt(cell);
+        if (value != 0) {
+            graph.setDomainAt(cell, bit(value));
+            queue[queueTail++] = cell;
+        } else {
+            graph.setDomainAt(cell, scan.masks[cell]);
+        }
+    }
+
+    for (int w = 0; w < CandidateScan<Order>::WORDS; w++) {
+        for (std::uint64_t singles = scan.singles[w]; singles != 0; singles &= singles - 1) {
+            int cell = w * 64 + __builtin_ctzll(singles);
+            assign(cell, __builtin_ctz(scan.masks[cell]) + 1);
+        }
+    }
+    return true;
+}
+
+template <int Order>
+bool BasicConstraintPropagator<Order>::assign(int cell, int value) {
+    Mask domain = graph.getDomainAt(cell);
+    if ((domain & bit(value)) == 0) {
+        return false;
+    }
+
+    graph.setValueAt(cell, value);
+    trail[trailSize++] = cell * DIGIT_SLOTS;
+
+    // Record every other digit of the domain as removed
+    for (Mask rest = static_cast<Mask>(domain & ~bit(value)); rest != 0; rest &= static_cast<Mask>(rest - 1)) {
+        trail[trailSize++] = cell * DIGIT_SLOTS + __builtin_ctz(rest) + 1;
+    }
+    graph.setDomainAt(cell, bit(value));
+
+    queue[queueTail++] = cell;
+    return true;
+}
+
+template <int Order>
+bool BasicConstraintPropagator<Order>::eliminate(int cell, int value) {
+    Mask domain = graph.getDomainAt(cell);
+    if ((domain & bit(value)) == 0) {
+        return true;
+    }
+
+    domain &= static_cast<Mask>(~bit(value));
+    graph.setDomainAt(cell, domain);
+    trail[trailSize++] = cell * DIGIT_SLOTS + value;
+
+    if (domain == 0) {
+        return false;
+    }
+
+    // Naked single
+    if ((domain & (domain - 1)) == 0 && graph.getValueAt(cell) == 0) {
+        return assign(cell, __builtin_ctz(domain) + 1);
+    }
+    return true;
+}
+
+template <int Order>
+bool BasicConstraintPropagator<Order>::assignHiddenSingles(bool& progress) {
+    for (int unit = 0; unit < Traits::UNITS; unit++) {
+        for (int d = 1; d <= Traits::SIDE; d++) {
+            int count = 0;
+            int place = -1;
+
+            for (int i = 0; i < Traits::SIDE && count < 2; i++) {
+                int cell = boardUnits<Order>.cells[unit][i];
+                if (graph.getDomainAt(cell) & bit(d)) {
+                    count++;
+                    place = cell;
+                }
+            }
+
+            if (count == 0) {
+                return false; // Digit d has no place left in this unit
+            }
+            if (count == 1 && graph.getValueAt(place) == 0) {
+                if (!assign(place, d)) {
+                    return false;
+                }
+                progress = true;
+            }
+        }
+    }
+    return true;
+}
+
+// Run naked and hidden singles to a fixpoint
+template <int Order>
+bool BasicConstraintPropagator<Order>::propagate() {
+    bool progress = true;
+
+    while (progress) {
+        while (queueHead < queueTail) {
+            int cell = queue[queueHead++];
+            int value = graph.getValueAt(cell);
+
+            for (int k = 0; k < Traits::PEERS; k++) {
+                if (!eliminate(boardTopology<Order>.peers[cell][k], value)) {
+                    return false;
+                }
+            }
+        }
+
+        progress = false;
+        if (!assignHiddenSingles(progress)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int Order>
+void BasicConstraintPropagator<Order>::undo(int mark) {
+    while (trailSize > mark) {
+        int entry = trail[--trailSize];
+        int digit = entry % DIGIT_SLOTS;
+        int cell = entry / DIGIT_SLOTS;
+
+        if (digit == 0) {
+            graph.setValueAt(cell, 0);
+        } else {
+            graph.setDomainAt(cell, static_cast<Mask>(graph.getDomainAt(cell) | bit(digit)));
+        }
+    }
+}
+
+// Unassigned cell with the smallest domain, or -1 when the grid is full
+template <int Order>
+int BasicConstraintPropagator<Order>::pickBranchCell() const {
+    int best = -1;
+    int bestSize = Traits::SIDE + 1;
+
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        if (graph.getValueAt(cell) == 0) {
+            int size = countCandidates(graph.getDomainAt(cell));
+            if (size < bestSize) {
+                best = cell;
+                bestSize = size;
+            }
+        }
+    }
+    return best;
+}
+
+template <int Order>
+bool BasicConstraintPropagator<Order>::search() {
+    searchNodes++;
+    
+    if (limits != nullptr && limits->shouldStop()) {
+        return false;
+    }
+
+    if (!propagate()) {
+        return false;
+    }
+
+    int cell = pickBranchCell();
+    if (cell == -1) {
+        return true;
+    }
+
+    for (Mask domain = graph.getDomainAt(cell); domain != 0; domain &= static_cast<Mask>(domain - 1)) {
+        int d = __builtin_ctz(domain) + 1;
+        int mark = trailSize;
+        guesses++;
+        queueHead = 0;
+        queueTail = 0;
+
+        if (assign(cell, d) && search()) {
+            return true;
+        }
+        undo(mark);
+    }
+    return false;
+}
+
+template <int Order>
+bool BasicConstraintPropagator<Order>::solve(const SearchLimits* searchLimits) {
+    limits = searchLimits;
+    guesses = 0;
+    searchNodes = 0;
+
+    if (!initialize()) {
+        return false;
+    }
+
+    if (search()) {
+        return true;
+    }
+
+    undo(0);
+    return false;
+}
+
+template class BasicConstraintPropagator<3>;
+template class BasicConstraintPropagator<4>;
+template class BasicConstraintPropagator<5>;
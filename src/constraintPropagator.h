@@ -0,0 +1,66 @@
+#ifndef CONSTRAINTPROPAGATOR_H
+#define CONSTRAINTPROPAGATOR_H
+
+#include "graph.h"
+#include "candidateScan.h"
+#include "searchControl.h"
+
+// Constraint-propagation solver working on the Node domains of a graph of any
+// supported board order (ConstraintPropagator is the 9x9 one).
+//
+// Assignments are propagated to the peers of each cell; naked singles (a
+// domain reduced to one value) and hidden singles (a digit that fits in only
+// one cell of a row, column or box) are assigned immediately, and an empty
+// domain or an unplaceable digit is reported as a contradiction. The solver
+// only branches when propagation stalls, always on the smallest domain.
+// Every domain removal and assignment is recorded on a trail, so backtracking
+// just replays the trail down to a mark.
+template <int Order>
+class BasicConstraintPropagator {
+public:
+    typedef BoardTraits<Order> Traits;
+    typedef typename Traits::Mask Mask;
+
+    explicit BasicConstraintPropagator(BasicGraph<Order>& sudokuGraph);
+
+    // Solve the graph in place; on failure (or when the limits stop the
+    // search) the unknown cells are left empty
+    bool solve(const SearchLimits* limits = nullptr);
+
+    long long getGuesses() const;       // Branching decisions taken
+    long long getSearchNodes() const;   // Search nodes visited
+
+private:
+    // Each cell is assigned once and each (cell, digit) removed once per path
+    static const int TRAIL_CAPACITY = Traits::CELLS * (Traits::SIDE + 1);
+    static const int DIGIT_SLOTS = 32;  // Trail entries pack cell * DIGIT_SLOTS + digit
+
+    BasicGraph<Order>& graph;
+    bool complete;              // Every cell of the board has a node
+
+    int trail[TRAIL_CAPACITY];  // cell * 32 + digit for a removal, cell * 32 for an assignment
+    int trailSize;
+
+    int queue[Traits::CELLS];   // Assigned cells whose value still has to reach the peers
+    int queueHead;
+    int queueTail;
+
+    long long guesses;
+    long long searchNodes;
+    const SearchLimits* limits;
+
+    static Mask bit(int digit) { return static_cast<Mask>(Mask(1) << (digit - 1)); }
+
+    bool initialize();
+    bool assign(int cell, int value);
+    bool eliminate(int cell, int value);
+    bool assignHiddenSingles(bool& progress);
+    bool propagate();
+    void undo(int mark);
+    int pickBranchCell() const;
+    bool search();
+};
+
+typedef BasicConstraintPropagator<3> ConstraintPropagator;
+
+#endif
@@ -0,0 +1,207 @@
+#include "dancingLinks.h"
+
+// Build the full 729 x 324 exact-cover matrix once
+DancingLinks::DancingLinks()
+    : solutionDepth(0), solutionLimit(1), solutionsFound(0), searchNodes(0), limits(nullptr) {
+    links = new Link[NODES];
+
+    // Root and column headers form a circular horizontal list
+    for (int i = 0; i <= COLUMNS; i++) {
+        links[i].left = (i == 0) ? COLUMNS : i - 1;
+        links[i].right = (i == COLUMNS) ? 0 : i + 1;
+        links[i].up = i;
+        links[i].down = i;
+        links[i].column = i;
+        links[i].row = -1;
+        columnSize[i] = 0;
+    }
+
+    for (int row = 0; row < ROWS; row++) {
+        int cell = row / 9;
+        int digit = row % 9;
+        int r = cell / 9;
+        int c = cell % 9;
+        int box = (r / 3) * 3 + c / 3;
+
+        int columns[4] = {
+            1 + cell,
+            1 + 81 + r * 9 + digit,
+            1 + 162 + c * 9 + digit,
+            1 + 243 + box * 9 + digit
+        };
+
+        int first = rowNode(row);
+        for (int k = 0; k < 4; k++) {
+            int node = first + k;
+            int header = columns[k];
+
+            // Append at the bottom of the column
+            links[node].column = header;
+            links[node].row = row;
+            links[node].down = header;
+            links[node].up = links[header].up;
+            links[links[header].up].down = node;
+            links[header].up = node;
+            columnSize[header]++;
+
+            // Circular list of the four nodes of this row
+            links[node].left = first + (k + 3) % 4;
+            links[node].right = first + (k + 1) % 4;
+        }
+    }
+}
+
+DancingLinks::~DancingLinks() {
+    delete[] links;
+}
+
+long long DancingLinks::getSearchNodes() const {
+    return searchNodes;
+}
+
+int DancingLinks::rowNode(int row) const {
+    return 1 + COLUMNS + row * 4;
+}
+
+bool DancingLinks::isColumnActive(int column) const {
+    return links[links[column].left].right == column;
+}
+
+void DancingLinks::cover(int column) {
+    links[links[column].right].left = links[column].left;
+    links[links[column].left].right = links[column].right;
+
+    for (int i = links[column].down; i != column; i = links[i].down) {
+        for (int j = links[i].right; j != i; j = links[j].right) {
+            links[links[j].down].up = links[j].up;
+            links[links[j].up].down = links[j].down;
+            columnSize[links[j].column]--;
+        }
+    }
+}
+
+void DancingLinks::uncover(int column) {
+    for (int i = links[column].up; i != column; i = links[i].up) {
+        for (int j = links[i].left; j != i; j = links[j].left) {
+            columnSize[links[j].column]++;
+            links[links[j].down].up = j;
+            links[links[j].up].down = j;
+        }
+    }
+
+    links[links[column].right].left = column;
+    links[links[column].left].right = column;
+}
+
+// Algorithm X: branch on the column with the fewest remaining rows.
+// Returns true once solutionLimit solutions have been found; the rows of the
+// last one are left in solution[]. The matrix is always fully restored.
+bool DancingLinks::search(int depth) {
+    if (links[0].right == 0) {
+        solutionDepth = depth;
+        return ++solutionsFound >= solutionLimit;
+    }
+
+    int best = links[0].right;
+    for (int c = links[best].right; c != 0; c = links[c].right) {
+        if (columnSize[c] < columnSize[best]) {
+            best = c;
+        }
+    }
+
+    if (columnSize[best] == 0 || (limits != nullptr && limits->shouldStop())) {
+        return false;
+    }
+
+    bool found = false;
+    cover(best);
+
+    for (int r = links[best].down; r != best && !found; r = links[r].down) {
+        searchNodes++;
+        solution[depth] = links[r].row;
+
+        for (int j = links[r].right; j != r; j = links[j].right) {
+            cover(links[j].column);
+        }
+
+        found = search(depth + 1);
+
+        for (int j = links[r].left; j != r; j = links[j].left) {
+            uncover(links[j].column);
+        }
+    }
+
+    uncover(best);
+    return found;
+}
+
+bool DancingLinks::solve(int grid[81], const SearchLimits* searchLimits) {
+    if (run(grid, 1, searchLimits) == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < solutionDepth; i++) {
+        grid[solution[i] / 9] = solution[i] % 9 + 1;
+    }
+    return true;
+}
+
+int DancingLinks::countSolutions(const int grid[81], int limit, const SearchLimits* searchLimits) {
+    if (limit < 1) {
+        return 0;
+    }
+    return run(grid, limit, searchLimits);
+}
+
+int DancingLinks::run(const int grid[81], int limit, const SearchLimits* searchLimits) {
+    limits = searchLimits;
+    searchNodes = 0;
+    solutionDepth = 0;
+    solutionLimit = limit;
+    solutionsFound = 0;
+
+    // Select the rows of the givens by covering their four columns
+    int givenRows[81];
+    int givenCount = 0;
+    bool consistent = true;
+
+    for (int cell = 0; cell < 81 && consistent; cell++) {
+        int value = grid[cell];
+        if (value == 0) {
+            continue;
+        }
+        if (value < 1 || value > 9) {
+            consistent = false;
+            break;
+        }
+
+        int node = rowNode(cell * 9 + value - 1);
+        for (int k = 0; k < 4; k++) {
+            if (!isColumnActive(links[node + k].column)) {
+                consistent = false; // Two givens claim the same constraint
+            }
+        }
+        if (!consistent) {
+            break;
+        }
+
+        for (int k = 0; k < 4; k++) {
+            cover(links[node + k].column);
+        }
+        givenRows[givenCount++] = node;
+    }
+
+    if (consistent) {
+        search(0);
+    }
+
+    // Restore the matrix for the next puzzle
+    while (givenCount > 0) {
+        int node = givenRows[--givenCount];
+        for (int k = 3; k >= 0; k--) {
+            uncover(links[node + k].column);
+        }
+    }
+
+    return solutionsFound;
+}
@@ -0,0 +1,66 @@
+#ifndef DANCINGLINKS_H
+#define DANCINGLINKS_H
+
+#include "searchControl.h"
+
+// Exact-cover solver (Knuth's Algorithm X with Dancing Links) for 9x9 Sudoku.
+//
+// The matrix has 324 columns (cell, row-digit, column-digit and box-digit
+// constraints) and 729 rows (one per cell/digit candidate). All links live in
+// one contiguous arena allocated by the constructor; solving only relinks
+// them, and the matrix is restored after every call so an instance can be
+// reused for any number of puzzles.
+class DancingLinks {
+public:
+    static const int COLUMNS = 324;
+    static const int ROWS = 729;
+    static const int NODES = 1 + COLUMNS + ROWS * 4; // root + headers + row nodes
+
+    DancingLinks();
+    ~DancingLinks();
+
+    // Solve the puzzle in grid (81 values in row-major order, 0 = empty).
+    // On success the grid is filled in; returns false if the givens conflict
+    // or the puzzle has no solution (or the limits stopped the search).
+    bool solve(int grid[81], const SearchLimits* limits = nullptr);
+
+    // Count the solutions of the puzzle in grid, stopping as soon as limit of
+    // them have been found (limit = 2 is enough to decide uniqueness). The
+    // grid is not modified. A search stopped by the limits returns the count
+    // reached so far.
+    int countSolutions(const int grid[81], int limit, const SearchLimits* limits = nullptr);
+
+    // Number of search nodes visited by the last solve
+    long long getSearchNodes() const;
+
+private:
+    struct Link {
+        int left;
+        int right;
+        int up;
+        int down;
+        int column;     // Header index of this node's column
+        int row;        // Candidate row (cell * 9 + digit - 1), -1 for headers
+    };
+
+    Link* links;                // Contiguous arena: [0] root, [1..324] headers, then rows
+    int columnSize[COLUMNS + 1];
+    int solution[81];           // Candidate rows picked by the search
+    int solutionDepth;
+    int solutionLimit;          // Stop once this many solutions were found
+    int solutionsFound;
+    long long searchNodes;
+    const SearchLimits* limits;
+
+    DancingLinks(const DancingLinks&);
+    DancingLinks& operator=(const DancingLinks&);
+
+    void cover(int column);
+    void uncover(int column);
+    bool isColumnActive(int column) const;
+    int rowNode(int row) const;
+    bool search(int depth);
+    int run(const int grid[81], int limit, const SearchLimits* limits);
+};
+
+#endif
@@ -10,6 +10,15 @@ dynamicArray::dynamicArray() {
     for (int i = 0; i < SIZE; ++i)
         grid[i] = new int[SIZE];
     initialize_grid();
+    seed(static_cast<unsigned long long>(std::time(nullptr)));
+}
+
+dynamicArray::dynamicArray(unsigned long long value) {
+    grid = new int*[SIZE];
+    for (int i = 0; i < SIZE; ++i)
+        grid[i] = new int[SIZE];
+    initialize_grid();
+    seed(value);
 }
 
 dynamicArray::~dynamicArray() {
@@ -32,6 +41,29 @@ void dynamicArray::print_grid() {
     }
 }
 
+std::string dynamicArray::to_line() {
+    std::string line(SIZE * SIZE, '.');
+    for (int i = 0; i < SIZE; ++i)
+        for (int j = 0; j < SIZE; ++j)
+            if (grid[i][j] != 0)
+                line[i * SIZE + j] = static_cast<char>('0' + grid[i][j]);
+    return line;
+}
+
+// Equal seeds give equal puzzles, independent of the thread that runs them
+void dynamicArray::seed(unsigned long long value) {
+    randomState = value;
+    randomState = nextRandom();
+}
+
+// splitmix64: one add and three multiply/xor-shift rounds per number
+unsigned long long dynamicArray::nextRandom() {
+    unsigned long long z = (randomState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
 bool dynamicArray::isSafe(int row, int col, int num) {
     for (int x = 0; x < SIZE; x++)
         if (grid[row][x] == num || grid[x][col] == num)
@@ -46,26 +78,21 @@ bool dynamicArray::isSafe(int row, int col, int num) {
     return true;
 }
 
-bool dynamicArray::findEmptyCell(int &row, int &col) {
-    for (row = 0; row < SIZE; row++) {
-        for (col = 0; col < SIZE; col++) {
-            if (grid[row][col] == 0)
-                return true;
-        }
-    }
-    return false;
-}
-
-bool dynamicArray::Solve() {
-
-}
-
+// Uniform integer in [min, max] (multiply-shift range reduction)
 int dynamicArray::randomGenerator(int min, int max) {
-
+    unsigned long long range = static_cast<unsigned long long>(max - min + 1);
+    return min + static_cast<int>(((nextRandom() >> 32) * range) >> 32);
 }
 
+// Fill the 3x3 box at (row, col) with a random permutation of 1..9
 void dynamicArray::fillBox(int row, int col) {
+    int digits[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (int i = SIZE - 1; i > 0; --i)
+        std::swap(digits[i], digits[randomGenerator(0, i)]);
 
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            grid[row + i][col + j] = digits[i * 3 + j];
 }
 
 void dynamicArray::fillDiagonalBoxes() {
@@ -102,13 +129,134 @@ bool dynamicArray::fillRemaining(int i, int j) {
     return false;
 }
 
-void dynamicArray::removeDigits(int count) {
-    while (count != 0) {
-        int i = randomGenerator(0, SIZE - 1);
-        int j = randomGenerator(0, SIZE - 1);
-        if (grid[i][j] != 0) {
+// Remove up to count clues in random order. A clue is only removed if the
+// puzzle stays unique: since the current puzzle has exactly one solution,
+// that holds unless the emptied cell can take another digit, so each step
+// is a single search for a solution that avoids the removed value.
+int dynamicArray::removeDigits(int count) {
+    int order[81];
+    for (int i = 0; i < SIZE * SIZE; ++i)
+        order[i] = i;
+    for (int i = SIZE * SIZE - 1; i > 0; --i)
+        std::swap(order[i], order[randomGenerator(0, i)]);
+
+    resetSearch();
+    int removed = 0;
+    for (int k = 0; k < SIZE * SIZE && removed < count; ++k) {
+        int i = order[k] / SIZE;
+        int j = order[k] % SIZE;
+        int value = grid[i][j];
+        if (value == 0)
+            continue;
+
+        if (!hasOtherSolution(i, j, value)) {
             grid[i][j] = 0;
-            count--;
+            removed++;
         }
     }
+    return removed;
+}
+
+void dynamicArray::generate(int clues) {
+    initialize_grid();
+    fillDiagonalBoxes();
+    fillRemaining(0, 3);
+    removeDigits(SIZE * SIZE - clues);
+}
+
+// Build the search state from the grid
+void dynamicArray::resetSearch() {
+    search.emptyCount = 0;
+    for (int i = 0; i < SIZE; ++i)
+        search.rows[i] = search.cols[i] = search.boxes[i] = 0;
+
+    for (int i = 0; i < SIZE; ++i) {
+        for (int j = 0; j < SIZE; ++j) {
+            if (grid[i][j] == 0) {
+                search.empty[search.emptyCount++] = static_cast<unsigned char>(i * SIZE + j);
+                continue;
+            }
+            unsigned short bit = static_cast<unsigned short>(1 << (grid[i][j] - 1));
+            search.rows[i] |= bit;
+            search.cols[j] |= bit;
+            search.boxes[(i / 3) * 3 + j / 3] |= bit;
+        }
+    }
+}
+
+// True if the puzzle without the clue at (row, col) has a solution in which
+// that cell is not value. The clue is taken out of the search state and
+// only put back when such a solution exists; searchSolution leaves the state
+// as it found it, so the state is reused across all the removals.
+bool dynamicArray::hasOtherSolution(int row, int col, int value) {
+    unsigned short bit = static_cast<unsigned short>(1 << (value - 1));
+    int box = (row / 3) * 3 + col / 3;
+    search.rows[row] &= static_cast<unsigned short>(~bit);
+    search.cols[col] &= static_cast<unsigned short>(~bit);
+    search.boxes[box] &= static_cast<unsigned short>(~bit);
+    search.empty[search.emptyCount++] = static_cast<unsigned char>(row * SIZE + col);
+
+    if (!searchSolution(search, row * SIZE + col, bit))
+        return false;
+
+    // The cell is the last empty entry again
+    search.emptyCount--;
+    search.rows[row] |= bit;
+    search.cols[col] |= bit;
+    search.boxes[box] |= bit;
+    return true;
+}
+
+// Depth-first search on the most constrained cell; stops at the first solution
+bool dynamicArray::searchSolution(SearchState& state, int bannedCell, unsigned short bannedBit) {
+    if (state.emptyCount == 0)
+        return true;
+
+    int best = -1;
+    unsigned bestMask = 0;
+    int bestCount = 10;
+    for (int k = 0; k < state.emptyCount; ++k) {
+        int cell = state.empty[k];
+        int i = cell / SIZE;
+        int j = cell % SIZE;
+        unsigned mask = ~(state.rows[i] | state.cols[j] | state.boxes[(i / 3) * 3 + j / 3]) & 0x1FFu;
+        if (cell == bannedCell)
+            mask &= ~static_cast<unsigned>(bannedBit);
+
+        int count = __builtin_popcount(mask);
+        if (count < bestCount) {
+            best = k;
+            bestMask = mask;
+            bestCount = count;
+            if (count <= 1)
+                break;
+        }
+    }
+    if (bestCount == 0)
+        return false;
+
+    // Take the cell out of the empty list (swap with the last entry)
+    int cell = state.empty[best];
+    state.empty[best] = state.empty[--state.emptyCount];
+    int i = cell / SIZE;
+    int j = cell % SIZE;
+    int box = (i / 3) * 3 + j / 3;
+
+    bool found = false;
+    while (bestMask != 0 && !found) {
+        unsigned short bit = static_cast<unsigned short>(bestMask & (0u - bestMask));
+        bestMask ^= bit;
+
+        state.rows[i] |= bit;
+        state.cols[j] |= bit;
+        state.boxes[box] |= bit;
+        found = searchSolution(state, bannedCell, bannedBit);
+        state.rows[i] &= static_cast<unsigned short>(~bit);
+        state.cols[j] &= static_cast<unsigned short>(~bit);
+        state.boxes[box] &= static_cast<unsigned short>(~bit);
+    }
+
+    state.empty[state.emptyCount++] = state.empty[best];
+    state.empty[best] = static_cast<unsigned char>(cell);
+    return found;
 }
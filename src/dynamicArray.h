@@ -1,26 +1,53 @@
 #ifndef DYNAMICARRAY_H
 #define DYNAMICARRAY_H
 #include <iostream>
-using namespace std;
+#include <string>
 
+// Puzzle generator: fills a random solution grid (diagonal boxes first, then
+// the rest by backtracking) and removes clues while the puzzle keeps a
+// unique solution.
 class dynamicArray {
 private:
     int** grid;
     const int SIZE = 9;
+    unsigned long long randomState;     // splitmix64 state
+
+    // Candidate masks of the uniqueness check, indexed by row/column/box
+    struct SearchState {
+        unsigned short rows[9];
+        unsigned short cols[9];
+        unsigned short boxes[9];
+        unsigned char empty[81];        // Unfilled cells (row * 9 + col)
+        int emptyCount;
+    };
+    SearchState search;                 // Follows grid while removeDigits runs
+
+    unsigned long long nextRandom();
+    void resetSearch();
+    bool hasOtherSolution(int row, int col, int value);
+    bool searchSolution(SearchState& state, int bannedCell, unsigned short bannedBit);
+
 public:
+    // Clue-count targets for generate(); HARD is reached on a best-effort basis
+    enum Difficulty { EASY = 40, MEDIUM = 32, HARD = 24 };
+
     dynamicArray();
+    explicit dynamicArray(unsigned long long seed);
     ~dynamicArray();
     void initialize_grid();
     void print_grid();
+    std::string to_line();              // 81 characters, '.' for empty cells
+    void seed(unsigned long long value);
     bool isSafe(int row, int col, int num);
-    bool Solve(); // Will be integrated with the Stack class to solve using backtracking
-    bool findEmptyCell(int &row, int &col);
+
+    // Generate a unique-solution puzzle with (at least) the given number of clues
+    void generate(int clues);
 
     void fillDiagonalBoxes();
     void fillBox(int row, int col);
     bool fillRemaining(int row, int col);
-    void removeDigits(int count);
-    int randomGenerator(int min, int max);  //will be integrated with the set
+    int removeDigits(int count);        // Returns the number of clues removed
+    int randomGenerator(int min, int max);
 };
 
 
@@ -1,99 +1,130 @@
 #include "graph.h"
 #include <iostream>
+#include <iomanip>
+#include <string>
 
 // Edge implementation
-Edge::Edge(Node* src, Node* dest) : source(src), destination(dest), next(nullptr) {}
+template <int Order>
+BasicEdge<Order>::BasicEdge(BasicNode<Order>* src, BasicNode<Order>* dest) : source(src), destination(dest), next(nullptr) {}
 
-Edge::~Edge() {
+template <int Order>
+BasicEdge<Order>::~BasicEdge() {
     next = nullptr;
 }
 
-Node* Edge::getSource() const {
+template <int Order>
+BasicNode<Order>* BasicEdge<Order>::getSource() const {
     return source;
 }
 
-Node* Edge::getDestination() const {
+template <int Order>
+BasicNode<Order>* BasicEdge<Order>::getDestination() const {
     return destination;
 }
 
-Edge* Edge::getNext() const {
+template <int Order>
+BasicEdge<Order>* BasicEdge<Order>::getNext() const {
     return next;
 }
 
-void Edge::setNext(Edge* nextEdge) {
+template <int Order>
+void BasicEdge<Order>::setNext(BasicEdge* nextEdge) {
     next = nextEdge;
 }
 
 // Node implementation
-Node::Node(int nodeId, int r, int c) : id(nodeId), row(r), col(c), value(0), edgeList(nullptr), edgeCount(0) {
-    // Initialize domain - all values (1-9) are available initially
+template <int Order>
+BasicNode<Order>::BasicNode(int nodeId, int r, int c)
+    : id(nodeId), row(r), col(c), value(&ownValue), domain(&ownDomain), ownValue(0), ownDomain(0),
+      edgeList(nullptr), edgeCount(0), graph(nullptr), peers(nullptr) {
+    // Initialize domain - all values (1-SIDE) are available initially
     resetDomain();
 }
 
-Node::~Node() {
+template <int Order>
+BasicNode<Order>::~BasicNode() {
     // Delete all edges in the edge list
-    Edge* current = edgeList;
+    BasicEdge<Order>* current = edgeList;
     while (current != nullptr) {
-        Edge* next = current->next;
+        BasicEdge<Order>* next = current->next;
         delete current;
         current = next;
     }
     edgeList = nullptr;
 }
 
-int Node::getId() const {
+template <int Order>
+int BasicNode<Order>::getId() const {
     return id;
 }
 
-int Node::getRow() const {
+template <int Order>
+int BasicNode<Order>::getRow() const {
     return row;
 }
 
-int Node::getCol() const {
+template <int Order>
+int BasicNode<Order>::getCol() const {
     return col;
 }
 
-int Node::getValue() const {
-    return value;
+template <int Order>
+int BasicNode<Order>::getValue() const {
+    return *value;
 }
 
-void Node::setValue(int val) {
-    value = val;
+template <int Order>
+void BasicNode<Order>::setValue(int val) {
+    if (graph != nullptr && val != *value) {
+        graph->updateMasks(row, col, *value, val);
+    }
+    *value = val;
 }
 
-bool Node::isValueInDomain(int val) const {
-    if (val < 1 || val > 9) return false;
-    return domain[val-1];
+template <int Order>
+bool BasicNode<Order>::isValueInDomain(int val) const {
+    if (val < 1 || val > Traits::SIDE) return false;
+    return (*domain >> (val - 1)) & 1;
 }
 
-void Node::removeFromDomain(int val) {
-    if (val >= 1 && val <= 9 && domain[val-1]) {
-        domain[val-1] = false;
+template <int Order>
+void BasicNode<Order>::removeFromDomain(int val) {
+    if (val >= 1 && val <= Traits::SIDE) {
+        *domain &= static_cast<Mask>(~(Mask(1) << (val - 1)));
     }
 }
 
-void Node::resetDomain() {
-    for (int i = 0; i < 9; i++) {
-        domain[i] = true;
+template <int Order>
+void BasicNode<Order>::addToDomain(int val) {
+    if (val >= 1 && val <= Traits::SIDE) {
+        *domain |= static_cast<Mask>(Mask(1) << (val - 1));
     }
 }
 
-int Node::getDomainSize() const {
-    int size = 0;
-    for (int i = 0; i < 9; i++) {
-        if (domain[i]) size++;
-    }
-    return size;
+template <int Order>
+void BasicNode<Order>::resetDomain() {
+    *domain = Traits::FULL_MASK;
+}
+
+template <int Order>
+int BasicNode<Order>::getDomainSize() const {
+    return countCandidates(*domain);
 }
 
-void Node::addEdge(Node* neighbor) {
+template <int Order>
+typename BasicNode<Order>::Mask BasicNode<Order>::getDomainMask() const {
+    return *domain;
+}
+
+template <int Order>
+void BasicNode<Order>::addEdge(BasicNode* neighbor) {
     // Check if edge already exists
     if (isConnectedTo(neighbor)) {
         return;
     }
     
     // Create new edge
-    Edge* newEdge = new Edge(this, neighbor);
+    BasicEdge<Order>* newEdge = new BasicEdge<Order>(this, neighbor);
     
     // Add to the beginning of the edge list
     newEdge->next = edgeList;
@@ -101,8 +132,21 @@ void Node::addEdge(Node* neighbor) {
     edgeCount++;
 }
 
-bool Node::isConnectedTo(Node* node) const {
-    Edge* current = edgeList;
+template <int Order>
+bool BasicNode<Order>::isConnectedTo(BasicNode* node) const {
+    if (node == nullptr || node == this) {
+        return false;
+    }
+    
+    // Sudoku peers share a row, column or box
+    if (peers != nullptr && node->peers != nullptr && node->graph == graph) {
+        if (row == node->row || col == node->col ||
+            (row / Order == node->row / Order && col / Order == node->col / Order)) {
+            return true;
+        }
+    }
+    
+    BasicEdge<Order>* current = edgeList;
     while (current != nullptr) {
         if (current->destination == node) {
             return true;
@@ -112,35 +156,230 @@ bool Node::isConnectedTo(Node* node) const {
     return false;
 }
 
-Edge* Node::getEdgeList() const {
+template <int Order>
+BasicEdge<Order>* BasicNode<Order>::getEdgeList() const {
     return edgeList;
 }
 
-int Node::getEdgeCount() const {
-    return edgeCount;
+template <int Order>
+int BasicNode<Order>::getEdgeCount() const {
+    return edgeCount + getPeerCount();
+}
+
+template <int Order>
+int BasicNode<Order>::getPeerCount() const {
+    return peers != nullptr ? Traits::PEERS : 0;
+}
+
+template <int Order>
+BasicNode<Order>* BasicNode<Order>::getPeer(int index) const {
+    if (peers == nullptr || index < 0 || index >= Traits::PEERS) {
+        return nullptr;
+    }
+    return graph->nodeAtCell(peers[index]);
 }
 
 // Graph implementation
-Graph::Graph(int initialCapacity) : nodeCount(0), capacity(initialCapacity) {
-    nodes = new Node*[capacity];
+template <int Order>
+BasicGraph<Order>::BasicGraph(int initialCapacity) : nodeCount(0), capacity(initialCapacity), positionIndex(nullptr), indexSide(0) {
+    nodes = new NodeType*[capacity];
     for (int i = 0; i < capacity; i++) {
         nodes[i] = nullptr;
     }
+    
+    growPositionIndex(Traits::SIDE);
+    
+    for (int i = 0; i < Traits::SIDE; i++) {
+        rowMask[i] = 0;
+        colMask[i] = 0;
+        boxMask[i] = 0;
+    }
+    
+    for (int unit = 0; unit < Traits::UNITS; unit++) {
+        for (int d = 0; d < Traits::SIDE; d++) {
+            digitCount[unit][d] = 0;
+        }
+    }
+    
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        values[cell] = 0;
+        domains[cell] = Traits::FULL_MASK;
+    }
+}
+
+template <int Order>
+BasicGraph<Order>::BasicGraph(const BasicGraph& other) : nodes(nullptr), nodeCount(0), capacity(0), positionIndex(nullptr), indexSide(0) {
+    copyFrom(other);
 }
 
-Graph::~Graph() {
+template <int Order>
+BasicGraph<Order>& BasicGraph<Order>::operator=(const BasicGraph& other) {
+    if (this != &other) {
+        clear();
+        copyFrom(other);
+    }
+    return *this;
+}
+
+template <int Order>
+BasicGraph<Order>::~BasicGraph() {
+    clear();
+}
+
+template <int Order>
+void BasicGraph<Order>::clear() {
     // Delete all nodes
     for (int i = 0; i < nodeCount; i++) {
         delete nodes[i];
     }
     delete[] nodes;
+    nodes = nullptr;
+    nodeCount = 0;
+    capacity = 0;
+    
+    delete[] positionIndex;
+    positionIndex = nullptr;
+    indexSide = 0;
 }
 
-Node* Graph::addNode(int row, int col) {
+// Deep copy: the nodes of the copy must point back at the copy, not at other
+template <int Order>
+void BasicGraph<Order>::copyFrom(const BasicGraph& other) {
+    capacity = other.capacity;
+    nodeCount = other.nodeCount;
+    nodes = new NodeType*[capacity];
+    
+    for (int i = 0; i < capacity; i++) {
+        nodes[i] = nullptr;
+    }
+    
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        values[cell] = other.values[cell];
+        domains[cell] = other.domains[cell];
+    }
+    
+    for (int i = 0; i < nodeCount; i++) {
+        const NodeType* source = other.nodes[i];
+        NodeType* copy = new NodeType(source->id, source->row, source->col);
+        attachStorage(copy, source->value != &source->ownValue);
+        copy->ownValue = source->ownValue;
+        copy->ownDomain = source->ownDomain;
+        copy->graph = this;
+        copy->peers = source->peers;
+        nodes[i] = copy;
+    }
+    
+    indexSide = other.indexSide;
+    positionIndex = new NodeType*[indexSide * indexSide];
+    for (int i = 0; i < indexSide * indexSide; i++) {
+        NodeType* indexed = other.positionIndex[i];
+        positionIndex[i] = indexed != nullptr ? nodes[indexed->id] : nullptr;
+    }
+    
+    // Recreate the edges in the same order, without the duplicate check
+    for (int i = 0; i < nodeCount; i++) {
+        EdgeType* tail = nullptr;
+        for (EdgeType* e = other.nodes[i]->edgeList; e != nullptr; e = e->next) {
+            EdgeType* newEdge = new EdgeType(nodes[i], nodes[e->destination->id]);
+            if (tail == nullptr) {
+                nodes[i]->edgeList = newEdge;
+            } else {
+                tail->next = newEdge;
+            }
+            tail = newEdge;
+        }
+        nodes[i]->edgeCount = other.nodes[i]->edgeCount;
+    }
+    
+    for (int i = 0; i < Traits::SIDE; i++) {
+        rowMask[i] = other.rowMask[i];
+        colMask[i] = other.colMask[i];
+        boxMask[i] = other.boxMask[i];
+    }
+    
+    for (int unit = 0; unit < Traits::UNITS; unit++) {
+        for (int d = 0; d < Traits::SIDE; d++) {
+            digitCount[unit][d] = other.digitCount[unit][d];
+        }
+    }
+}
+
+// Point the node at its grid cell's slots, or at its own storage
+template <int Order>
+void BasicGraph<Order>::attachStorage(NodeType* node, bool gridCell) {
+    if (gridCell) {
+        int cell = node->row * Traits::SIDE + node->col;
+        node->value = &values[cell];
+        node->domain = &domains[cell];
+    } else {
+        node->value = &node->ownValue;
+        node->domain = &node->ownDomain;
+    }
+}
+
+template <int Order>
+void BasicGraph<Order>::growPositionIndex(int minSide) {
+    int newSide = indexSide > 0 ? indexSide : minSide;
+    while (newSide < minSide) {
+        newSide *= 2;
+    }
+    
+    NodeType** newIndex = new NodeType*[newSide * newSide];
+    for (int i = 0; i < newSide * newSide; i++) {
+        newIndex[i] = nullptr;
+    }
+    
+    for (int r = 0; r < indexSide; r++) {
+        for (int c = 0; c < indexSide; c++) {
+            newIndex[r * newSide + c] = positionIndex[r * indexSide + c];
+        }
+    }
+    
+    delete[] positionIndex;
+    positionIndex = newIndex;
+    indexSide = newSide;
+}
+
+template <int Order>
+BasicNode<Order>* BasicGraph<Order>::nodeAtCell(int cell) const {
+    return positionIndex[(cell / Traits::SIDE) * indexSide + cell % Traits::SIDE];
+}
+
+template <int Order>
+void BasicGraph<Order>::updateMasks(int row, int col, int oldValue, int newValue) {
+    const int side = Traits::SIDE;
+    if (row < 0 || row >= side || col < 0 || col >= side) {
+        return;
+    }
+    
+    int box = Traits::boxOf(row, col);
+    
+    if (oldValue >= 1 && oldValue <= side) {
+        int d = oldValue - 1;
+        Mask bit = static_cast<Mask>(Mask(1) << d);
+        if (--digitCount[row][d] == 0) rowMask[row] &= static_cast<Mask>(~bit);
+        if (--digitCount[side + col][d] == 0) colMask[col] &= static_cast<Mask>(~bit);
+        if (--digitCount[2 * side + box][d] == 0) boxMask[box] &= static_cast<Mask>(~bit);
+    }
+    
+    if (newValue >= 1 && newValue <= side) {
+        int d = newValue - 1;
+        Mask bit = static_cast<Mask>(Mask(1) << d);
+        digitCount[row][d]++;
+        digitCount[side + col][d]++;
+        digitCount[2 * side + box][d]++;
+        rowMask[row] |= bit;
+        colMask[col] |= bit;
+        boxMask[box] |= bit;
+    }
+}
+
+template <int Order>
+BasicNode<Order>* BasicGraph<Order>::addNode(int row, int col) {
     if (nodeCount >= capacity) {
         // Resize the array if needed
         int newCapacity = capacity * 2;
-        Node** newNodes = new Node*[newCapacity];
+        NodeType** newNodes = new NodeType*[newCapacity];
         
         for (int i = 0; i < capacity; i++) {
             newNodes[i] = nodes[i];
@@ -156,14 +395,33 @@ Node* Graph::addNode(int row, int col) {
     }
     
     // Create new node
-    Node* newNode = new Node(nodeCount, row, col);
+    NodeType* newNode = new NodeType(nodeCount, row, col);
+    newNode->graph = this;
     nodes[nodeCount] = newNode;
     nodeCount++;
     
+    // Index non-negative positions; the first node added at a position wins
+    // (and, on the grid, owns the cell's value and domain slots)
+    bool gridCell = false;
+    if (row >= 0 && col >= 0) {
+        if (row >= indexSide || col >= indexSide) {
+            growPositionIndex((row > col ? row : col) + 1);
+        }
+        if (positionIndex[row * indexSide + col] == nullptr) {
+            positionIndex[row * indexSide + col] = newNode;
+            gridCell = row < Traits::SIDE && col < Traits::SIDE;
+        }
+    }
+    
+    attachStorage(newNode, gridCell);
+    newNode->setValue(0);
+    newNode->resetDomain();
+    
     return newNode;
 }
 
-void Graph::addEdge(Node* source, Node* destination) {
+template <int Order>
+void BasicGraph<Order>::addEdge(NodeType* source, NodeType* destination) {
     if (source == nullptr || destination == nullptr) {
         return;
     }
@@ -173,14 +431,24 @@ void Graph::addEdge(Node* source, Node* destination) {
     destination->addEdge(source);
 }
 
-Node* Graph::getNode(int id) const {
+template <int Order>
+BasicNode<Order>* BasicGraph<Order>::getNode(int id) const {
     if (id >= 0 && id < nodeCount) {
         return nodes[id];
     }
     return nullptr;
 }
 
-Node* Graph::getNodeByPosition(int row, int col) const {
+template <int Order>
+BasicNode<Order>* BasicGraph<Order>::getNodeByPosition(int row, int col) const {
+    if (row >= 0 && col >= 0) {
+        if (row >= indexSide || col >= indexSide) {
+            return nullptr;
+        }
+        return positionIndex[row * indexSide + col];
+    }
+    
+    // Negative positions are not indexed
     for (int i = 0; i < nodeCount; i++) {
         if (nodes[i]->getRow() == row && nodes[i]->getCol() == col) {
             return nodes[i];
@@ -189,93 +457,95 @@ Node* Graph::getNodeByPosition(int row, int col) const {
     return nullptr;
 }
 
-int Graph::getNodeCount() const {
+template <int Order>
+int BasicGraph<Order>::getNodeCount() const {
     return nodeCount;
 }
 
-void Graph::buildSudokuConstraints() {
-    // Create 81 nodes for a 9x9 Sudoku grid
-    for (int row = 0; row < 9; row++) {
-        for (int col = 0; col < 9; col++) {
-            addNode(row, col);
-        }
-    }
-    
-    // Add edges for Sudoku constraints
-    for (int row = 0; row < 9; row++) {
-        for (int col = 0; col < 9; col++) {
-            Node* current = getNodeByPosition(row, col);
-            
-            // Add row constraints
-            for (int c = 0; c < 9; c++) {
-                if (c != col) {
-                    Node* neighbor = getNodeByPosition(row, c);
-                    addEdge(current, neighbor);
-                }
-            }
-            
-            // Add column constraints
-            for (int r = 0; r < 9; r++) {
-                if (r != row) {
-                    Node* neighbor = getNodeByPosition(r, col);
-                    addEdge(current, neighbor);
-                }
-            }
-            
-            // Add 3x3 box constraints
-            int boxStartRow = (row / 3) * 3;
-            int boxStartCol = (col / 3) * 3;
-            
-            for (int r = boxStartRow; r < boxStartRow + 3; r++) {
-                for (int c = boxStartCol; c < boxStartCol + 3; c++) {
-                    if (r != row || c != col) {
-                        Node* neighbor = getNodeByPosition(r, c);
-                        addEdge(current, neighbor);
-                    }
-                }
+template <int Order>
+void BasicGraph<Order>::buildSudokuConstraints() {
+    // Create the nodes of the grid (reusing any that already exist) and
+    // attach them to the shared peer topology
+    for (int row = 0; row < Traits::SIDE; row++) {
+        for (int col = 0; col < Traits::SIDE; col++) {
+            NodeType* cell = getNodeByPosition(row, col);
+            if (cell == nullptr) {
+                cell = addNode(row, col);
             }
+            cell->peers = boardTopology<Order>.peers[row * Traits::SIDE + col];
         }
     }
 }
 
-void Graph::printSudokuGrid() const {
-    std::cout << "+-------+-------+-------+" << std::endl;
+template <int Order>
+void BasicGraph<Order>::clearValues() {
+    for (int i = 0; i < nodeCount; i++) {
+        nodes[i]->setValue(0);
+        nodes[i]->resetDomain();
+    }
+}
+
+template <int Order>
+void BasicGraph<Order>::printSudokuGrid() const {
+    // One character per value up to 9x9, two (right-aligned) above
+    const int width = Traits::SIDE > 9 ? 2 : 1;
+    std::string separator = "+";
+    for (int box = 0; box < Order; box++) {
+        separator += std::string(Order * (width + 1) + 1, '-') + "+";
+    }
+    
+    std::cout << separator << std::endl;
     
-    for (int row = 0; row < 9; row++) {
+    for (int row = 0; row < Traits::SIDE; row++) {
         std::cout << "| ";
         
-        for (int col = 0; col < 9; col++) {
-            Node* cell = getNodeByPosition(row, col);
+        for (int col = 0; col < Traits::SIDE; col++) {
+            NodeType* cell = getNodeByPosition(row, col);
             int value = cell->getValue();
             
             if (value == 0) {
-                std::cout << ". ";
+                std::cout << std::setw(width) << "." << " ";
             } else {
-                std::cout << value << " ";
+                std::cout << std::setw(width) << value << " ";
             }
             
-            if (col % 3 == 2) {
+            if (col % Order == Order - 1) {
                 std::cout << "| ";
             }
         }
         
         std::cout << std::endl;
         
-        if (row % 3 == 2) {
-            std::cout << "+-------+-------+-------+" << std::endl;
+        if (row % Order == Order - 1) {
+            std::cout << separator << std::endl;
         }
     }
 }
 
-bool Graph::isValidSudokuValue(Node* node, int value) const {
-    if (node == nullptr || value < 1 || value > 9) {
+template <int Order>
+bool BasicGraph<Order>::isValidSudokuValue(NodeType* node, int value) const {
+    if (node == nullptr || value < 1 || value > Traits::SIDE) {
         return false;
     }
     
+    // Fast path: one AND against the row, column and box occupancy masks.
+    // A cell never conflicts with its own value, so that case (and nodes
+    // outside the grid) still goes through the neighbor scan below.
+    if (node->graph == this && value != *node->value &&
+        node->row >= 0 && node->row < Traits::SIDE && node->col >= 0 && node->col < Traits::SIDE) {
+        return (getCandidateMask(node) >> (value - 1)) & 1;
+    }
+    
     // Check if any neighbor has the same value
-    Edge* current = node->getEdgeList();
+    for (int i = 0; i < node->getPeerCount(); i++) {
+        if (node->getPeer(i)->getValue() == value) {
+            return false;
+        }
+    }
+    
+    EdgeType* current = node->getEdgeList();
     while (current != nullptr) {
-        Node* neighbor = current->getDestination();
+        NodeType* neighbor = current->getDestination();
         if (neighbor->getValue() == value) {
             return false;
         }
@@ -284,3 +554,46 @@ bool Graph::isValidSudokuValue(Node* node, int value) const {
     
     return true;
 }
+
+
+template <int Order>
+typename BasicGraph<Order>::Mask BasicGraph<Order>::getCandidateMask(const NodeType* node) const {
+    if (node == nullptr || node->row < 0 || node->row >= Traits::SIDE || node->col < 0 || node->col >= Traits::SIDE) {
+        return 0;
+    }
+    
+    int box = Traits::boxOf(node->row, node->col);
+    return static_cast<Mask>(~(rowMask[node->row] | colMask[node->col] | boxMask[box]) & Traits::FULL_MASK);
+}
+
+template <int Order>
+void BasicGraph<Order>::setValueAt(int cell, int value) {
+    int old = values[cell];
+    if (old != value) {
+        updateMasks(cell / Traits::SIDE, cell % Traits::SIDE, old, value);
+        values[cell] = value;
+    }
+}
+
+template <int Order>
+bool BasicGraph<Order>::hasConflicts() const {
+    for (int unit = 0; unit < Traits::UNITS; unit++) {
+        for (int d = 0; d < Traits::SIDE; d++) {
+            if (digitCount[unit][d] > 1) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The supported board orders: 9x9, 16x16 and 25x25
+template class BasicEdge<3>;
+template class BasicNode<3>;
+template class BasicGraph<3>;
+template class BasicEdge<4>;
+template class BasicNode<4>;
+template class BasicGraph<4>;
+template class BasicEdge<5>;
+template class BasicNode<5>;
+template class BasicGraph<5>;
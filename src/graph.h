@@ -1,43 +1,121 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-// Forward declaration
-class Node;
+#include <cstdint>
+#include <type_traits>
+
+// Compile-time parameters of an N^2 x N^2 board of box order N (3 = 9x9).
+// Candidate sets are fixed-width bitsets: bit (v-1) stands for digit v, so
+// 9x9 and 16x16 boards use 16-bit masks and 25x25 boards 32-bit masks.
+template <int Order>
+struct BoardTraits {
+    static_assert(Order >= 2 && Order <= 5, "supported box orders are 2 to 5");
+
+    static const int ORDER = Order;                 // Box side
+    static const int SIDE = Order * Order;          // Rows, columns, boxes and digits
+    static const int CELLS = SIDE * SIDE;
+    static const int UNITS = 3 * SIDE;              // Rows, then columns, then boxes
+    static const int PEERS = 2 * (SIDE - 1) + (Order - 1) * (Order - 1);
+
+    typedef typename std::conditional<(SIDE <= 16), std::uint16_t, std::uint32_t>::type Mask;
+    typedef typename std::conditional<(CELLS <= 256), unsigned char, unsigned short>::type CellIndex;
+
+    static constexpr Mask FULL_MASK = static_cast<Mask>((1ULL << SIDE) - 1);
+
+    static constexpr int boxOf(int row, int col) {
+        return (row / Order) * Order + col / Order;
+    }
+};
+
+// Number of candidates in a mask. Written out because without a popcnt
+// target __builtin_popcount becomes a library call.
+inline int countCandidates(std::uint32_t mask) {
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return static_cast<int>((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// Peer topology of the board: peers[cell] lists the cells (row * SIDE + col),
+// in increasing order, sharing a row, column or box with cell. Computed at
+// compile time and shared read-only by every graph of that order, so building
+// the constraints allocates no edges.
+template <int Order>
+struct BoardTopology {
+    typedef BoardTraits<Order> Traits;
+    typename Traits::CellIndex peers[Traits::CELLS][Traits::PEERS];
+};
+
+template <int Order>
+constexpr BoardTopology<Order> makeBoardTopology() {
+    typedef BoardTraits<Order> Traits;
+    BoardTopology<Order> topology{};
+    for (int cell = 0; cell < Traits::CELLS; cell++) {
+        int row = cell / Traits::SIDE, col = cell % Traits::SIDE;
+        int count = 0;
+        for (int r = 0; r < Traits::SIDE; r++) {
+            for (int c = 0; c < Traits::SIDE; c++) {
+                bool sameBox = (r / Order == row / Order) && (c / Order == col / Order);
+                if ((r != row || c != col) && (r == row || c == col || sameBox)) {
+                    topology.peers[cell][count++] = static_cast<typename Traits::CellIndex>(r * Traits::SIDE + c);
+                }
+            }
+        }
+    }
+    return topology;
+}
+
+template <int Order>
+inline constexpr BoardTopology<Order> boardTopology = makeBoardTopology<Order>();
+
+template <int Order> class BasicNode;
+template <int Order> class BasicGraph;
 
 // Edge class to represent connections between nodes
-class Edge {
+template <int Order>
+class BasicEdge {
 private:
-    Node* source;
-    Node* destination;
-    Edge* next; // For linked list of edges
+    BasicNode<Order>* source;
+    BasicNode<Order>* destination;
+    BasicEdge* next; // For linked list of edges
 
 public:
-    Edge(Node* src, Node* dest);
-    ~Edge();
+    BasicEdge(BasicNode<Order>* src, BasicNode<Order>* dest);
+    ~BasicEdge();
     
-    Node* getSource() const;
-    Node* getDestination() const;
-    Edge* getNext() const;
-    void setNext(Edge* nextEdge);
+    BasicNode<Order>* getSource() const;
+    BasicNode<Order>* getDestination() const;
+    BasicEdge* getNext() const;
+    void setNext(BasicEdge* nextEdge);
     
-    friend class Graph;
-    friend class Node;
+    friend class BasicGraph<Order>;
+    friend class BasicNode<Order>;
 };
 
-// Node class to represent a cell in the Sudoku puzzle
-class Node {
+// Node class to represent a cell in the Sudoku puzzle. The value and domain
+// of a node on the grid live in its graph's per-cell arrays (the node is a
+// view over them); other nodes keep them in ownValue / ownDomain.
+template <int Order>
+class BasicNode {
+public:
+    typedef BoardTraits<Order> Traits;
+    typedef typename Traits::Mask Mask;
+
 private:
     int id;             // Unique identifier
     int row;            // Row position in Sudoku grid
     int col;            // Column position in Sudoku grid
-    int value;          // Current value (0 if unassigned)
-    bool domain[9];     // Available values (true if available)
-    Edge* edgeList;     // List of edges connecting to other nodes
-    int edgeCount;      // Number of edges
+    int* value;         // Current value (0 if unassigned)
+    Mask* domain;       // Available values (bit v-1 set if v is available)
+    int ownValue;       // Storage for nodes without a grid cell
+    Mask ownDomain;
+    BasicEdge<Order>* edgeList; // List of explicit edges connecting to other nodes
+    int edgeCount;      // Number of explicit edges
+    BasicGraph<Order>* graph;   // Owning graph (keeps its occupancy masks in sync)
+    const typename Traits::CellIndex* peers; // Sudoku peers from the shared topology (or nullptr)
 
 public:
-    Node(int nodeId, int r, int c);
-    ~Node();
+    BasicNode(int nodeId, int r, int c);
+    ~BasicNode();
     
     int getId() const;
     int getRow() const;
@@ -47,38 +125,107 @@ public:
     
     bool isValueInDomain(int val) const;
     void removeFromDomain(int val);
+    void addToDomain(int val);
     void resetDomain();
     int getDomainSize() const;
+    Mask getDomainMask() const;
     
-    void addEdge(Node* neighbor);
-    bool isConnectedTo(Node* node) const;
-    Edge* getEdgeList() const;
+    void addEdge(BasicNode* neighbor);
+    bool isConnectedTo(BasicNode* node) const;
+    BasicEdge<Order>* getEdgeList() const;
     int getEdgeCount() const;
     
-    friend class Graph;
+    int getPeerCount() const;
+    BasicNode* getPeer(int index) const;
+    
+    friend class BasicGraph<Order>;
 };
 
 // Graph class to represent the entire Sudoku puzzle
-class Graph {
+template <int Order>
+class BasicGraph {
+public:
+    typedef BoardTraits<Order> Traits;
+    typedef typename Traits::Mask Mask;
+    typedef BasicNode<Order> NodeType;
+    typedef BasicEdge<Order> EdgeType;
+
 private:
-    Node** nodes;       // Array of node pointers
+    NodeType** nodes;   // Array of node pointers
     int nodeCount;      // Number of nodes
     int capacity;       // Maximum capacity of nodes array
+    
+    // Node state by cell (row * SIDE + col), structure-of-arrays: solver
+    // loops over values or domains touch a few contiguous cache lines
+    // instead of one heap object per cell
+    int values[Traits::CELLS];
+    Mask domains[Traits::CELLS];
+    
+    // Dense (row, col) -> Node* index, indexSide x indexSide, filled by addNode
+    NodeType** positionIndex;
+    int indexSide;
+
+    // Occupancy masks indexing the node values: bit (v-1) is set while
+    // digit v is placed somewhere in that row, column or box
+    Mask rowMask[Traits::SIDE];
+    Mask colMask[Traits::SIDE];
+    Mask boxMask[Traits::SIDE];
+    
+    // Occurrences of each digit per unit (rows, then columns, then boxes), so
+    // a mask bit is only cleared once no cell of the unit holds the digit
+    unsigned char digitCount[Traits::UNITS][Traits::SIDE];
+
+    void updateMasks(int row, int col, int oldValue, int newValue);
+    void growPositionIndex(int minSide);
+    void copyFrom(const BasicGraph& other);
+    void attachStorage(NodeType* node, bool gridCell);
+    void clear();
+    NodeType* nodeAtCell(int cell) const;
 
 public:
-    Graph(int initialCapacity = 81); // Default for 9x9 Sudoku
-    ~Graph();
+    BasicGraph(int initialCapacity = Traits::CELLS);
+    BasicGraph(const BasicGraph& other);
+    BasicGraph& operator=(const BasicGraph& other);
+    ~BasicGraph();
     
-    Node* addNode(int row, int col);
-    void addEdge(Node* source, Node* destination);
-    Node* getNode(int id) const;
-    Node* getNodeByPosition(int row, int col) const;
+    NodeType* addNode(int row, int col);
+    void addEdge(NodeType* source, NodeType* destination);
+    NodeType* getNode(int id) const;
+    NodeType* getNodeByPosition(int row, int col) const;
     int getNodeCount() const;
     
     // Utility functions for Sudoku
     void buildSudokuConstraints();
+    void clearValues();
     void printSudokuGrid() const;
-    bool isValidSudokuValue(Node* node, int value) const;
+    bool isValidSudokuValue(NodeType* node, int value) const;
+    Mask getCandidateMask(const NodeType* node) const; // Bit (v-1) set if v is still allowed
+    bool hasConflicts() const;  // True if a digit is placed twice in a row, column or box
+    
+    // Cell-indexed access to the node state (cell = row * SIDE + col) for
+    // the solver hot loops; the cell must hold a node (buildSudokuConstraints)
+    int getValueAt(int cell) const { return values[cell]; }
+    void setValueAt(int cell, int value);
+    Mask getDomainAt(int cell) const { return domains[cell]; }
+    void setDomainAt(int cell, Mask domain) { domains[cell] = domain; }
+    Mask getCandidateMaskAt(int cell) const {
+        int row = cell / Traits::SIDE, col = cell % Traits::SIDE;
+        return static_cast<Mask>(~(rowMask[row] | colMask[col] | boxMask[Traits::boxOf(row, col)]) & Traits::FULL_MASK);
+    }
+
+    // The occupancy masks and cell values as whole arrays, for the kernels
+    // that work on every cell at once (candidateScan.h)
+    const Mask* getRowMasks() const { return rowMask; }
+    const Mask* getColMasks() const { return colMask; }
+    const Mask* getBoxMasks() const { return boxMask; }
+    const int* getValues() const { return values; }
+
+    friend class BasicNode<Order>;
 };
 
+// The classic 9x9 board; larger boards use BasicGraph<4> (16x16) and BasicGraph<5> (25x25)
+typedef BasicEdge<3> Edge;
+typedef BasicNode<3> Node;
+typedef BasicGraph<3> Graph;
+
 #endif
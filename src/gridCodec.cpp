@@ -0,0 +1,62 @@
+#include "gridCodec.h"
+
+void packGrid(const int grid[81], unsigned char packed[PACKED_GRID_SIZE]) {
+    for (int cell = 0; cell < 80; cell += 2) {
+        packed[cell / 2] = static_cast<unsigned char>((grid[cell] << 4) | grid[cell + 1]);
+    }
+    packed[40] = static_cast<unsigned char>(grid[80] << 4);
+}
+
+bool unpackGrid(const unsigned char packed[PACKED_GRID_SIZE], int grid[81]) {
+    for (int cell = 0; cell < 80; cell += 2) {
+        grid[cell] = packed[cell / 2] >> 4;
+        grid[cell + 1] = packed[cell / 2] & 0x0F;
+        if (grid[cell] > 9 || grid[cell + 1] > 9) {
+            return false;
+        }
+    }
+    grid[80] = packed[40] >> 4;
+    return grid[80] <= 9 && (packed[40] & 0x0F) == 0;
+}
+
+void packDigits(const char digits[81], unsigned char packed[PACKED_GRID_SIZE]) {
+    for (int cell = 0; cell < 80; cell += 2) {
+        packed[cell / 2] = static_cast<unsigned char>(((digits[cell] - '0') << 4) | (digits[cell + 1] - '0'));
+    }
+    packed[40] = static_cast<unsigned char>((digits[80] - '0') << 4);
+}
+
+bool unpackDigits(const unsigned char packed[PACKED_GRID_SIZE], char digits[81]) {
+    for (int cell = 0; cell < 80; cell += 2) {
+        unsigned high = packed[cell / 2] >> 4;
+        unsigned low = packed[cell / 2] & 0x0F;
+        if (high > 9 || low > 9) {
+            return false;
+        }
+        digits[cell] = static_cast<char>('0' + high);
+        digits[cell + 1] = static_cast<char>('0' + low);
+    }
+    unsigned last = packed[40] >> 4;
+    digits[80] = static_cast<char>('0' + last);
+    return last <= 9 && (packed[40] & 0x0F) == 0;
+}
+
+void appendFrameHeader(std::string& frame, uint32_t count) {
+    frame += static_cast<char>(count >> 24);
+    frame += static_cast<char>(count >> 16);
+    frame += static_cast<char>(count >> 8);
+    frame += static_cast<char>(count);
+}
+
+bool readFrameHeader(std::string_view frame, size_t recordSize, size_t& count) {
+    if (frame.size() < FRAME_HEADER_SIZE) {
+        return false;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(frame.data());
+    uint32_t value = (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+                   | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    count = value;
+    // Divide rather than multiply, so a huge count cannot overflow
+    return (frame.size() - FRAME_HEADER_SIZE) % recordSize == 0
+        && (frame.size() - FRAME_HEADER_SIZE) / recordSize == count;
+}
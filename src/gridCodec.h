@@ -0,0 +1,50 @@
+#ifndef GRIDCODEC_H
+#define GRIDCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Compact binary encoding of 9x9 grids, the alternative to JSON for clients
+// of the GUI server's batch endpoint.
+//
+// A packed grid holds the 81 cell values (0 = empty) two per byte, row-major,
+// the first cell of each pair in the high nibble: 41 bytes, the last low
+// nibble being zero. A batch frame is a 4-byte big-endian grid count
+// followed by that many packed grids. A result frame has the same count,
+// and each grid is preceded by a PackedResult byte; the grid of a puzzle
+// that was not solved is all zeros.
+
+const size_t PACKED_GRID_SIZE = 41;
+const size_t FRAME_HEADER_SIZE = 4;
+
+// Media types negotiated through Content-Type and Accept
+const char* const BATCH_FRAME_TYPE = "application/x-sudoku-batch";
+const char* const RESULT_FRAME_TYPE = "application/x-sudoku-results";
+
+enum PackedResult : unsigned char {
+    PACKED_SOLVED = 0,
+    PACKED_NO_SOLUTION = 1,
+    PACKED_INVALID = 2,
+    PACKED_TIMED_OUT = 3
+};
+
+// Pack cell values 0-9
+void packGrid(const int grid[81], unsigned char packed[PACKED_GRID_SIZE]);
+
+// Unpack a grid; false if a value is above 9 or the padding nibble is set
+bool unpackGrid(const unsigned char packed[PACKED_GRID_SIZE], int grid[81]);
+
+// The same for 81 digits '0'-'9', the one-line format of the batch modes
+void packDigits(const char digits[81], unsigned char packed[PACKED_GRID_SIZE]);
+bool unpackDigits(const unsigned char packed[PACKED_GRID_SIZE], char digits[81]);
+
+// Append the count that starts a frame
+void appendFrameHeader(std::string& frame, uint32_t count);
+
+// Grid count of a frame whose records are recordSize bytes each; false if
+// the frame is shorter or longer than the count says
+bool readFrameHeader(std::string_view frame, size_t recordSize, size_t& count);
+
+#endif
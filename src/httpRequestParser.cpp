@@ -0,0 +1,347 @@
+#include "httpRequestParser.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const size_t MAX_CHUNK_LINE = 1024;
+
+// Up to this much of a body is reserved when its Content-Length is read;
+// larger bodies grow the buffer as they arrive, so a client cannot pin
+// memory by announcing a large body it never sends
+const size_t MAX_BODY_RESERVE = 64 * 1024;
+
+char lowerAscii(char ch) {
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (lowerAscii(a[i]) != lowerAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+// True if the comma-separated token list contains token
+bool hasToken(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (equalsIgnoreCase(trim(list.substr(0, comma)), token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (int i = 0; i < headerCount; i++) {
+        if (equalsIgnoreCase(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+HttpRequestParser::HttpRequestParser(size_t maxHeaderBytes, size_t maxBodyBytes)
+    : maxHeaderBytes(maxHeaderBytes), maxBodyBytes(maxBodyBytes) {
+    reset();
+}
+
+void HttpRequestParser::reset() {
+    state = REQUEST_HEAD;
+    status = INCOMPLETE;
+    scanned = 0;
+    bodyStart = 0;
+    bodyEnd = 0;
+    readOffset = 0;
+    contentLength = 0;
+    chunkRemaining = 0;
+    chunked = false;
+    continueExpected = false;
+    headerCount = 0;
+    keepAlive = true;
+    parsed = HttpRequest();
+}
+
+const HttpRequest& HttpRequestParser::request() const {
+    return parsed;
+}
+
+size_t HttpRequestParser::consumed() const {
+    return readOffset;
+}
+
+bool HttpRequestParser::expectsContinue() const {
+    return continueExpected && state != REQUEST_HEAD && state != DONE;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(Status error) {
+    state = DONE;
+    status = error;
+    continueExpected = false;
+    return error;
+}
+
+HttpRequestParser::Status HttpRequestParser::parse(std::string& buffer) {
+    if (state == DONE) {
+        return status;
+    }
+
+    if (state == REQUEST_HEAD) {
+        Status result = parseHead(buffer);
+        if (result != INCOMPLETE || state == REQUEST_HEAD) {
+            return result;
+        }
+    }
+
+    if (state == BODY) {
+        if (buffer.size() < bodyStart + contentLength) {
+            return INCOMPLETE;
+        }
+        bodyEnd = bodyStart + contentLength;
+        readOffset = bodyEnd;
+        return finish(buffer);
+    }
+    return parseChunked(buffer);
+}
+
+// Request line and header fields, once the blank line ending them arrived
+HttpRequestParser::Status HttpRequestParser::parseHead(std::string& buffer) {
+    // Resume a few bytes back: the terminator may straddle two reads
+    size_t end = buffer.find("\r\n\r\n", scanned);
+    if (end == std::string::npos) {
+        if (buffer.size() > maxHeaderBytes) {
+            return fail(HEADERS_TOO_LARGE);
+        }
+        scanned = buffer.size() >= 3 ? buffer.size() - 3 : 0;
+        return INCOMPLETE;
+    }
+    if (end + 4 > maxHeaderBytes) {
+        return fail(HEADERS_TOO_LARGE);
+    }
+
+    std::string_view head(buffer.data(), end);
+    size_t lineEnd = head.find("\r\n");
+    if (lineEnd == std::string_view::npos) {
+        lineEnd = end;
+    }
+
+    // method SP target SP version
+    std::string_view line = head.substr(0, lineEnd);
+    size_t firstSpace = line.find(' ');
+    size_t secondSpace = firstSpace == std::string_view::npos ? std::string_view::npos : line.find(' ', firstSpace + 1);
+    if (firstSpace == 0 || secondSpace == std::string_view::npos || secondSpace == firstSpace + 1
+        || line.find(' ', secondSpace + 1) != std::string_view::npos) {
+        return fail(BAD_REQUEST);
+    }
+    method = Span{0, firstSpace};
+    target = Span{firstSpace + 1, secondSpace - firstSpace - 1};
+    version = Span{secondSpace + 1, lineEnd - secondSpace - 1};
+
+    std::string_view versionText = line.substr(secondSpace + 1);
+    if (versionText.substr(0, 7) != "HTTP/1." || versionText.size() != 8) {
+        return fail(BAD_REQUEST);
+    }
+    keepAlive = versionText != "HTTP/1.0";
+
+    bool hasContentLength = false;
+    size_t pos = lineEnd + 2;
+    while (pos < end) {
+        size_t next = head.find("\r\n", pos);
+        if (next == std::string_view::npos) {
+            next = end;
+        }
+        std::string_view field = head.substr(pos, next - pos);
+        size_t colon = field.find(':');
+        if (colon == 0 || colon == std::string_view::npos || field[0] == ' ' || field[0] == '\t'
+            || field.find_first_of(" \t") < colon) {
+            return fail(BAD_REQUEST);
+        }
+        if (headerCount == HttpRequest::MAX_HEADERS) {
+            return fail(HEADERS_TOO_LARGE);
+        }
+
+        std::string_view name = field.substr(0, colon);
+        std::string_view value = trim(field.substr(colon + 1));
+        headerNames[headerCount] = Span{pos, colon};
+        headerValues[headerCount] = Span{value.empty() ? pos : static_cast<size_t>(value.data() - buffer.data()), value.size()};
+        headerCount++;
+
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string_view::npos) {
+                return fail(BAD_REQUEST);
+            }
+            size_t length = 0;
+            for (char ch : value) {
+                length = length * 10 + static_cast<size_t>(ch - '0');
+            }
+            if (hasContentLength && length != contentLength) {
+                return fail(BAD_REQUEST);
+            }
+            hasContentLength = true;
+            contentLength = length;
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            if (!equalsIgnoreCase(value, "chunked")) {
+                return fail(NOT_IMPLEMENTED);
+            }
+            chunked = true;
+        } else if (equalsIgnoreCase(name, "Connection")) {
+            if (hasToken(value, "close")) {
+                keepAlive = false;
+            } else if (hasToken(value, "keep-alive")) {
+                keepAlive = true;
+            }
+        } else if (equalsIgnoreCase(name, "Expect")) {
+            continueExpected = equalsIgnoreCase(value, "100-continue");
+        }
+
+        pos = next + 2;
+    }
+
+    // Both framings at once is how requests get smuggled past proxies
+    if (chunked && hasContentLength) {
+        return fail(BAD_REQUEST);
+    }
+
+    bodyStart = end + 4;
+    bodyEnd = bodyStart;
+    readOffset = bodyStart;
+    if (chunked) {
+        state = CHUNK_SIZE;
+    } else {
+        if (contentLength > maxBodyBytes) {
+            return fail(BODY_TOO_LARGE);
+        }
+        // Grow once for a typical body instead of once per read
+        buffer.reserve(bodyStart + std::min(contentLength, MAX_BODY_RESERVE));
+        state = BODY;
+    }
+    return INCOMPLETE;
+}
+
+// Decode chunks as they arrive, moving the data down over the chunk headers
+HttpRequestParser::Status HttpRequestParser::parseChunked(std::string& buffer) {
+    while (true) {
+        // Bound the chunk framing too, not only the decoded body
+        if (readOffset - bodyStart > 2 * maxBodyBytes + maxHeaderBytes) {
+            return fail(BODY_TOO_LARGE);
+        }
+
+        if (state == CHUNK_SIZE || state == CHUNK_TRAILER) {
+            size_t lineEnd = buffer.find("\r\n", readOffset);
+            if (lineEnd == std::string::npos) {
+                if (buffer.size() - readOffset > MAX_CHUNK_LINE) {
+                    return fail(state == CHUNK_SIZE ? BAD_REQUEST : HEADERS_TOO_LARGE);
+                }
+                return INCOMPLETE;
+            }
+
+            if (state == CHUNK_TRAILER) {
+                // Trailer fields are skipped; a blank line ends the request
+                bool blank = lineEnd == readOffset;
+                readOffset = lineEnd + 2;
+                if (blank) {
+                    return finish(buffer);
+                }
+                continue;
+            }
+
+            // Hex size, optionally followed by ;extensions
+            size_t size = 0;
+            size_t digits = 0;
+            size_t pos = readOffset;
+            for (; pos < lineEnd && hexValue(buffer[pos]) >= 0; pos++, digits++) {
+                if (digits == 15) {
+                    return fail(BODY_TOO_LARGE);
+                }
+                size = size * 16 + static_cast<size_t>(hexValue(buffer[pos]));
+            }
+            if (digits == 0 || (pos < lineEnd && buffer[pos] != ';' && buffer[pos] != ' ' && buffer[pos] != '\t')) {
+                return fail(BAD_REQUEST);
+            }
+
+            readOffset = lineEnd + 2;
+            if (size == 0) {
+                state = CHUNK_TRAILER;
+                continue;
+            }
+            if (size > maxBodyBytes - (bodyEnd - bodyStart)) {
+                return fail(BODY_TOO_LARGE);
+            }
+            chunkRemaining = size;
+            state = CHUNK_DATA;
+        } else if (state == CHUNK_DATA) {
+            size_t available = buffer.size() - readOffset;
+            size_t count = available < chunkRemaining ? available : chunkRemaining;
+            if (count == 0) {
+                return INCOMPLETE;
+            }
+            if (bodyEnd != readOffset) {
+                std::memmove(&buffer[bodyEnd], &buffer[readOffset], count);
+            }
+            bodyEnd += count;
+            readOffset += count;
+            chunkRemaining -= count;
+            if (chunkRemaining != 0) {
+                return INCOMPLETE;
+            }
+            state = CHUNK_DATA_END;
+        } else {
+            // CHUNK_DATA_END: the CRLF after the chunk data
+            if (buffer.size() - readOffset < 2) {
+                return INCOMPLETE;
+            }
+            if (buffer[readOffset] != '\r' || buffer[readOffset + 1] != '\n') {
+                return fail(BAD_REQUEST);
+            }
+            readOffset += 2;
+            state = CHUNK_SIZE;
+        }
+    }
+}
+
+HttpRequestParser::Status HttpRequestParser::finish(const std::string& buffer) {
+    const char* data = buffer.data();
+    parsed.method = std::string_view(data + method.offset, method.length);
+    parsed.target = std::string_view(data + target.offset, target.length);
+    parsed.version = std::string_view(data + version.offset, version.length);
+    parsed.headerCount = headerCount;
+    for (int i = 0; i < headerCount; i++) {
+        parsed.headers[i].name = std::string_view(data + headerNames[i].offset, headerNames[i].length);
+        parsed.headers[i].value = std::string_view(data + headerValues[i].offset, headerValues[i].length);
+    }
+    parsed.body = std::string_view(data + bodyStart, bodyEnd - bodyStart);
+    parsed.keepAlive = keepAlive;
+
+    state = DONE;
+    status = COMPLETE;
+    continueExpected = false;
+    return COMPLETE;
+}
@@ -0,0 +1,103 @@
+#ifndef HTTPREQUESTPARSER_H
+#define HTTPREQUESTPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// One parsed HTTP request. Every field is a view into the connection's
+// receive buffer and stays valid until the parser is reset.
+struct HttpRequest {
+    static const int MAX_HEADERS = 64;
+
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    std::string_view method;
+    std::string_view target;
+    std::string_view version;
+    Header headers[MAX_HEADERS];
+    int headerCount = 0;
+    std::string_view body;      // Already de-chunked
+    bool keepAlive = true;
+
+    // Value of the first header called name (case-insensitive), empty if none
+    std::string_view header(std::string_view name) const;
+};
+
+// Incremental HTTP/1.x request parser.
+//
+// parse() is called again whenever more bytes were appended to the buffer;
+// it resumes where it stopped instead of rescanning. Bodies are framed by
+// Content-Length or chunked transfer encoding; chunked bodies are decoded in
+// place inside the buffer, so in both cases the body is one contiguous view
+// and nothing is copied. Positions are kept as offsets until the request is
+// complete, so the buffer may reallocate while it grows.
+class HttpRequestParser {
+public:
+    enum Status {
+        INCOMPLETE,             // Need more bytes
+        COMPLETE,               // request() is ready; consumed() bytes belong to it
+        BAD_REQUEST,            // 400
+        HEADERS_TOO_LARGE,      // 431
+        BODY_TOO_LARGE,         // 413
+        NOT_IMPLEMENTED         // 501: a transfer coding other than chunked
+    };
+
+    HttpRequestParser(size_t maxHeaderBytes = 16 * 1024, size_t maxBodyBytes = 8 * 1024 * 1024);
+
+    // Parse the request at the start of buffer. Once COMPLETE (or an error)
+    // the status sticks until reset().
+    Status parse(std::string& buffer);
+
+    const HttpRequest& request() const;
+    size_t consumed() const;
+
+    // True once the headers of a request asking for "Expect: 100-continue"
+    // are in and its body is still missing
+    bool expectsContinue() const;
+
+    // Forget the current request; the caller drops consumed() bytes first
+    void reset();
+
+private:
+    enum State { REQUEST_HEAD, BODY, CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER, DONE };
+
+    struct Span {
+        size_t offset;
+        size_t length;
+    };
+
+    size_t maxHeaderBytes;
+    size_t maxBodyBytes;
+
+    State state;
+    Status status;
+    size_t scanned;             // Where the search for the next line end resumes
+    size_t bodyStart;
+    size_t bodyEnd;             // End of the (decoded) body so far
+    size_t readOffset;          // Next raw byte of a chunked body
+    size_t contentLength;
+    size_t chunkRemaining;
+    bool chunked;
+    bool continueExpected;
+
+    Span method;
+    Span target;
+    Span version;
+    Span headerNames[HttpRequest::MAX_HEADERS];
+    Span headerValues[HttpRequest::MAX_HEADERS];
+    int headerCount;
+    bool keepAlive;
+
+    HttpRequest parsed;
+
+    Status parseHead(std::string& buffer);
+    Status parseChunked(std::string& buffer);
+    Status finish(const std::string& buffer);
+    Status fail(Status error);
+};
+
+#endif
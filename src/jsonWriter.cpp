@@ -0,0 +1,55 @@
+#include "jsonWriter.h"
+#include <charconv>
+
+void appendJsonString(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+
+    // Copy runs of plain characters at once
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        out.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (ch) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[ch >> 4];
+                out += hex[ch & 0x0F];
+        }
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+    out += '"';
+}
+
+void appendJsonNumber(std::string& out, long long value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void appendJsonGrid(std::string& out, const int grid[81]) {
+    out += '[';
+    for (int row = 0; row < 9; row++) {
+        out += row == 0 ? "[" : ",[";
+        for (int col = 0; col < 9; col++) {
+            if (col > 0) {
+                out += ',';
+            }
+            appendJsonNumber(out, grid[row * 9 + col]);
+        }
+        out += ']';
+    }
+    out += ']';
+}
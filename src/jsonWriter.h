@@ -0,0 +1,20 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <string>
+#include <string_view>
+
+// JSON output for the GUI server's own messages and responses: values are
+// appended straight to the caller's buffer, with no json tree in between.
+// Untrusted input is still parsed with nlohmann::json.
+
+// Append text as a quoted JSON string, escaping quotes, backslashes and
+// control characters; other bytes are copied as they are
+void appendJsonString(std::string& out, std::string_view text);
+
+void appendJsonNumber(std::string& out, long long value);
+
+// Append a 9x9 grid as an array of 9 rows of 9 numbers
+void appendJsonGrid(std::string& out, const int grid[81]);
+
+#endif
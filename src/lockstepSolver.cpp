@@ -0,0 +1,165 @@
+#include "lockstepSolver.h"
+#include <cstring>
+#include "graph.h"
+
+namespace {
+
+const std::uint16_t FULL = BoardTraits<3>::FULL_MASK;
+
+// The 27 units of the board: rows, columns, then boxes
+struct UnitTable {
+    unsigned char cells[27][9];
+};
+
+constexpr UnitTable makeUnitTable() {
+    UnitTable table{};
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 9; j++) {
+            table.cells[i][j] = static_cast<unsigned char>(i * 9 + j);
+            table.cells[9 + i][j] = static_cast<unsigned char>(j * 9 + i);
+            table.cells[18 + i][j] = static_cast<unsigned char>(((i / 3) * 3 + j / 3) * 9 + (i % 3) * 3 + j % 3);
+        }
+    }
+    return table;
+}
+
+constexpr UnitTable units = makeUnitTable();
+
+// Lanes x 16-bit candidate masks as a GCC vector; the compiler maps the
+// operators onto whatever SIMD instructions the calling function targets
+template <int Lanes>
+struct LaneVector {
+    typedef std::uint16_t type __attribute__((vector_size(Lanes * sizeof(std::uint16_t))));
+};
+
+// Bit mask of the lanes of v that are not zero
+template <int Lanes>
+inline __attribute__((always_inline)) unsigned nonZeroLanes(const typename LaneVector<Lanes>::type& v) {
+    unsigned lanes = 0;
+    for (int lane = 0; lane < Lanes; lane++) {
+        lanes |= static_cast<unsigned>(v[lane] != 0) << lane;
+    }
+    return lanes;
+}
+
+// The propagation loop, written once for any lane count. Always inlined, so
+// each kernel below compiles it for its own instruction set.
+template <int Lanes>
+inline __attribute__((always_inline)) unsigned propagateLanes(std::uint16_t (*candidates)[LockstepSolver::MAX_LANES]) {
+    typedef typename LaneVector<Lanes>::type Vector;
+    const Vector zero = {};
+    const Vector one = zero + 1;
+    const Vector full = zero + FULL;
+
+    Vector cand[81];
+    for (int cell = 0; cell < 81; cell++) {
+        std::memcpy(&cand[cell], candidates[cell], sizeof(Vector));
+    }
+
+    Vector dead = zero;
+    Vector changed = one;
+    for (int pass = 0; pass < 729 && nonZeroLanes<Lanes>(changed & ~dead) != 0; pass++) {
+        changed = zero;
+
+        for (int unit = 0; unit < 27; unit++) {
+            const unsigned char* cells = units.cells[unit];
+
+            // Digits seen in at least one / two cells, and the digits of the
+            // fixed cells (a single candidate) seen once / twice
+            Vector once = zero, twice = zero, fixed = zero, fixedTwice = zero;
+            for (int i = 0; i < 9; i++) {
+                Vector mask = cand[cells[i]];
+                Vector single = mask & reinterpret_cast<Vector>((mask & (mask - one)) == zero);
+                twice |= once & mask;
+                once |= mask;
+                fixedTwice |= fixed & single;
+                fixed |= single;
+            }
+
+            // A digit with no place or fixed twice in the unit kills the lane
+            dead |= reinterpret_cast<Vector>(once != full) | fixedTwice;
+            Vector hidden = once & ~twice & ~fixed;
+
+            for (int i = 0; i < 9; i++) {
+                Vector mask = cand[cells[i]];
+                Vector isSingle = reinterpret_cast<Vector>((mask & (mask - one)) == zero);
+                Vector next = (mask & isSingle) | (mask & ~fixed & ~isSingle);
+                Vector hiddenHere = next & hidden;
+                Vector hasHidden = reinterpret_cast<Vector>(hiddenHere != zero);
+                next = (hiddenHere & hasHidden) | (next & ~hasHidden);
+                changed |= next ^ mask;
+                cand[cells[i]] = next;
+            }
+        }
+    }
+
+    // Solved: alive and every cell down to exactly one candidate
+    Vector open = zero;
+    for (int cell = 0; cell < 81; cell++) {
+        open |= cand[cell] & (cand[cell] - one);
+        dead |= reinterpret_cast<Vector>(cand[cell] == zero);
+        std::memcpy(candidates[cell], &cand[cell], sizeof(Vector));
+    }
+    return ~nonZeroLanes<Lanes>(open | dead) & ((1u << Lanes) - 1);
+}
+
+// Baseline vectors: SSE2 on x86-64, the native width elsewhere
+unsigned propagate8(std::uint16_t (*candidates)[LockstepSolver::MAX_LANES]) {
+    return propagateLanes<8>(candidates);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+unsigned propagate16(std::uint16_t (*candidates)[LockstepSolver::MAX_LANES]) {
+    return propagateLanes<16>(candidates);
+}
+
+bool avx2Supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+} // namespace
+
+LockstepSolver::LockstepSolver() : laneCount(8), kernel(propagate8), kernelName("sse2") {
+#if defined(__x86_64__) || defined(__i386__)
+    if (avx2Supported()) {
+        laneCount = 16;
+        kernel = propagate16;
+        kernelName = "avx2";
+    }
+#else
+    kernelName = "generic";
+#endif
+    clear();
+}
+
+int LockstepSolver::getLaneCount() const {
+    return laneCount;
+}
+
+const char* LockstepSolver::getKernelName() const {
+    return kernelName;
+}
+
+void LockstepSolver::clear() {
+    std::memset(candidates, 0, sizeof(candidates));
+}
+
+void LockstepSolver::load(int lane, const int grid[81]) {
+    for (int cell = 0; cell < 81; cell++) {
+        int value = grid[cell];
+        candidates[cell][lane] = value >= 1 && value <= 9 ? static_cast<std::uint16_t>(1u << (value - 1)) : FULL;
+    }
+}
+
+unsigned LockstepSolver::propagate() {
+    return kernel(candidates);
+}
+
+void LockstepSolver::getSolution(int lane, int grid[81]) const {
+    for (int cell = 0; cell < 81; cell++) {
+        grid[cell] = __builtin_ctz(candidates[cell][lane]) + 1;
+    }
+}
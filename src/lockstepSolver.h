@@ -0,0 +1,43 @@
+#ifndef LOCKSTEPSOLVER_H
+#define LOCKSTEPSOLVER_H
+
+#include <cstdint>
+
+// Constraint propagation over a batch of independent 9x9 puzzles, one puzzle
+// per SIMD lane, all advanced in lock-step.
+//
+// The candidates are stored cell-major (candidates[cell][lane]), so one
+// vector holds the same cell of every puzzle. Each pass walks the 27 units
+// once, removing the digits of fixed cells from their unit and fixing
+// hidden singles, until no lane changes any more. Propagation never guesses:
+// lanes it cannot finish (or finds contradictory) are left to a scalar
+// solver. With AVX2 a batch holds 16 puzzles, otherwise 8.
+class LockstepSolver {
+public:
+    static const int MAX_LANES = 16;
+
+    LockstepSolver();
+
+    int getLaneCount() const;
+    const char* getKernelName() const;
+
+    // Put a puzzle (81 values, row-major, 0 = empty) into a lane; lanes that
+    // are not loaded since the last clear() stay empty and never solve
+    void load(int lane, const int grid[81]);
+    void clear();
+
+    // Propagate every lane to a fixpoint. Returns a bitmask of the lanes
+    // whose puzzle was completely solved.
+    unsigned propagate();
+
+    // Solution of a lane reported solved by propagate()
+    void getSolution(int lane, int grid[81]) const;
+
+private:
+    alignas(32) std::uint16_t candidates[81][MAX_LANES];
+    int laneCount;
+    unsigned (*kernel)(std::uint16_t (*candidates)[MAX_LANES]);
+    const char* kernelName;
+};
+
+#endif
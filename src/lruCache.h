@@ -0,0 +1,60 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+// String-keyed map holding at most capacity entries. Every lookup marks the
+// entry as most recently used; creating an entry in a full cache evicts the
+// least recently used one. Entries live in a list, so references to them
+// stay valid until they are evicted. Not synchronized.
+template <typename Value>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {
+    }
+
+    // Entry for key, default-constructed if missing
+    Value& touch(const std::string& key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+
+        if (entries.size() == capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+        index[key] = entries.begin();
+        return entries.front().second;
+    }
+
+    // Entry for key, nullptr if missing (or evicted)
+    Value* find(const std::string& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+private:
+    typedef std::list<std::pair<std::string, Value>> EntryList;
+
+    size_t capacity;
+    EntryList entries;      // Most recently used first
+    std::unordered_map<std::string, typename EntryList::iterator> index;
+};
+
+#endif
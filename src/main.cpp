@@ -2,161 +2,202 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <condition_variable>
+#include <atomic>
+#include <mutex>
+#include <nlohmann/json.hpp>
 #include "graph.h"
 #include "stack.h"
 #include "binaryTree.h"
+#include "dancingLinks.h"
+#include "constraintPropagator.h"
+#include "cellQueue.h"
+#include "threadPool.h"
+#include "dynamicArray.h"
+#include "cacheMissCounter.h"
+#include "candidateScan.h"
+#include "lockstepSolver.h"
+#include "searchControl.h"
+#include "solveJobs.h"
+#include "lruCache.h"
+#include "gridCodec.h"
 #include "sudoku-gui-ipc.h"
 
-// Function to read Sudoku puzzle from file
-bool readSudokuFromFile(const std::string& filename, Graph& sudokuGraph) {
-    std::ifstream inputFile(filename);
-    if (!inputFile.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return false;
-    }
-
+// Read the cells of a puzzle, one grid row per line. Up to 9x9 every
+// character is a cell ('1'-'9', or '0', '.' or '*' when empty; commas and
+// spaces are skipped). Rows of larger boards either separate the cells with
+// spaces or commas, so values may have several digits, or write one
+// character per cell with letters after 9 ('A' = 10).
+template <int Order>
+bool readSudokuFromStream(std::istream& input, BasicGraph<Order>& sudokuGraph) {
+    const int side = BoardTraits<Order>::SIDE;
+    
     // Build the graph structure for Sudoku
     sudokuGraph.buildSudokuConstraints();
     
     std::string line;
     int row = 0;
     
-    while (std::getline(inputFile, line) && row < 9) {
+    while (row < side && std::getline(input, line)) {
+        size_t separator = line.find_first_of(", \t");
+        bool separated = side > 9 && separator != std::string::npos && separator < line.find_last_not_of(" \t\r");
         int col = 0;
-        for (size_t i = 0; i < line.length() && col < 9; i++) {
-            if (line[i] == ',' || line[i] == ' ') {
-                continue; // Skip commas and spaces
+        for (size_t i = 0; i < line.length() && col < side; i++) {
+            if (line[i] == ',' || line[i] == ' ' || line[i] == '\t' || line[i] == '\r') {
+                continue; // Skip separators
             }
             
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
+            BasicNode<Order>* cell = sudokuGraph.getNodeByPosition(row, col);
             if (cell == nullptr) {
                 std::cerr << "Error: Invalid cell position (" << row << "," << col << ")" << std::endl;
                 return false;
             }
             
-            if (line[i] >= '1' && line[i] <= '9') {
-                int value = line[i] - '0';
-                cell->setValue(value);
-            } else if (line[i] == '*' || line[i] == '0' || line[i] == '.') {
-                cell->setValue(0); // Empty cell
-            } else {
-                std::cerr << "Error: Invalid character in input file: " << line[i] << std::endl;
+            int value = -1;
+            char ch = line[i];
+            if (ch == '*' || ch == '.') {
+                value = 0;
+            } else if (ch >= '0' && ch <= '9') {
+                value = ch - '0';
+                while (separated && i + 1 < line.length() && line[i + 1] >= '0' && line[i + 1] <= '9') {
+                    value = value * 10 + (line[++i] - '0');
+                }
+            } else if (side > 9 && ch >= 'A' && ch <= 'Z') {
+                value = ch - 'A' + 10;
+            } else if (side > 9 && ch >= 'a' && ch <= 'z') {
+                value = ch - 'a' + 10;
+            }
+            
+            if (value < 0 || value > side) {
+                std::cerr << "Error: Invalid character in input: " << ch << std::endl;
                 return false;
             }
             
+            cell->setValue(value);
             col++;
         }
         
-        if (col < 9) {
-            std::cerr << "Error: Row " << row << " has fewer than 9 columns" << std::endl;
+        if (col < side) {
+            std::cerr << "Error: Row " << row << " has fewer than " << side << " columns" << std::endl;
             return false;
         }
         
         row++;
     }
     
-    if (row < 9) {
-        std::cerr << "Error: Input file has fewer than 9 rows" << std::endl;
+    if (row < side) {
+        std::cerr << "Error: Input has fewer than " << side << " rows" << std::endl;
         return false;
     }
     
-    inputFile.close();
     return true;
 }
 
+// Function to read Sudoku puzzle from file
+template <int Order>
+bool readSudokuFromFile(const std::string& filename, BasicGraph<Order>& sudokuGraph) {
+    std::ifstream inputFile(filename);
+    if (!inputFile.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    
+    return readSudokuFromStream(inputFile, sudokuGraph);
+}
+
 // Function to solve the Sudoku puzzle using backtracking
-bool solveSudoku(Graph& sudokuGraph) {
-    Stack moveStack;
-    
-    // Find first empty cell
-    for (int row = 0; row < 9; row++) {
-        for (int col = 0; col < 9; col++) {
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
-            if (cell->getValue() == 0) {
-                // Try values 1-9 for this cell
-                for (int val = 1; val <= 9; val++) {
-                    if (sudokuGraph.isValidSudokuValue(cell, val)) {
-                        // Place this value and push the move onto the stack
-                        cell->setValue(val);
-                        moveStack.push(Move(row, col, val));
-                        goto nextCell; // Move to the next empty cell
-                    }
-                }
-                
-                // If we get here, no valid value was found for this cell
-                // We need to backtrack
-                while (!moveStack.isEmpty()) {
-                    Move lastMove = moveStack.pop();
-                    Node* lastCell = sudokuGraph.getNodeByPosition(lastMove.row, lastMove.col);
-                    
-                    // Try the next value for the last cell
-                    bool foundNextValue = false;
-                    for (int val = lastMove.value + 1; val <= 9; val++) {
-                        if (sudokuGraph.isValidSudokuValue(lastCell, val)) {
-                            lastCell->setValue(val);
-                            moveStack.push(Move(lastMove.row, lastMove.col, val));
-                            foundNextValue = true;
-                            break;
-                        }
-                    }
-                    
-                    if (foundNextValue) {
-                        // Continue solving from this point
-                        row = lastMove.row;
-                        col = lastMove.col;
-                        goto nextCell;
-                    } else {
-                        // No valid value found, continue backtracking
-                        lastCell->setValue(0);
-                    }
-                }
-                
-                // If we've exhausted all possibilities, the puzzle is unsolvable
-                return false;
+template <int Order>
+bool solveSudoku(BasicGraph<Order>& sudokuGraph, SearchStats* stats = nullptr, const SearchLimits* limits = nullptr) {
+    // Each thread (batch worker) owns one move stack, reused across solves.
+    // A path fills every cell at most once, so it can never overflow.
+    static thread_local FixedStack<PackedMove, BoardTraits<Order>::CELLS> moveStack;
+    moveStack.clear();
+    BasicCellQueue<Order> queue(sudokuGraph);
+    long long nodes = 0;
+    PackedMove move;
+    
+    // Always branch on the most constrained empty cell (MRV)
+    while (!queue.isEmpty()) {
+        if (limits != nullptr && limits->shouldStop()) {
+            // Give up: take back every move so the graph holds the puzzle again
+            while (moveStack.pop(move)) {
+                sudokuGraph.setValueAt(move.cell(), 0);
             }
+            if (stats != nullptr) stats->nodes += nodes;
+            return false;
+        }
+        
+        int cell = queue.peekMostConstrained();
+        unsigned candidates = sudokuGraph.getCandidateMaskAt(cell);
+        
+        if (candidates != 0) {
+            // Place the smallest candidate and push the move onto the stack
+            int val = __builtin_ctz(candidates) + 1;
+            sudokuGraph.setValueAt(cell, val);
+            queue.assigned(cell);
+            moveStack.push(PackedMove(cell, val));
+            nodes++;
+            continue;
+        }
+        
+        // No valid value for this cell: backtrack to the last move that
+        // still has an untried value
+        bool foundNextValue = false;
+        while (!foundNextValue && moveStack.pop(move)) {
+            int lastIndex = move.cell();
             
-            nextCell:;
+            sudokuGraph.setValueAt(lastIndex, 0);
+            unsigned remaining = sudokuGraph.getCandidateMaskAt(lastIndex) & ~((1u << move.digit()) - 1);
+            
+            if (remaining != 0) {
+                int val = __builtin_ctz(remaining) + 1;
+                sudokuGraph.setValueAt(lastIndex, val);
+                queue.assigned(lastIndex);
+                moveStack.push(PackedMove(lastIndex, val));
+                nodes++;
+                foundNextValue = true;
+            } else {
+                queue.unassigned(lastIndex);
+            }
+        }
+        
+        // If we've exhausted all possibilities, the puzzle is unsolvable
+        if (!foundNextValue) {
+            if (stats != nullptr) stats->nodes += nodes;
+            return false;
         }
     }
     
+    if (stats != nullptr) stats->nodes += nodes;
     return true;
 }
 
-// Alternative solver using recursion and the binary tree for domain tracking
-bool solveWithBinaryTree(Graph& sudokuGraph) {
-    // Find an empty cell
-    int emptyRow = -1, emptyCol = -1;
-    for (int row = 0; row < 9; row++) {
-        for (int col = 0; col < 9; col++) {
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
-            if (cell->getValue() == 0) {
-                emptyRow = row;
-                emptyCol = col;
-                break;
-            }
-        }
-        if (emptyRow != -1) break;
-    }
-    
-    // If no empty cell is found, the puzzle is solved
-    if (emptyRow == -1) return true;
+// Recursive step of the binary tree solver
+bool solveWithBinaryTree(Graph& sudokuGraph, CellQueue& queue, SearchStats* stats, const SearchLimits* limits) {
+    // If no empty cell is left, the puzzle is solved
+    if (queue.isEmpty()) return true;
+    if (limits != nullptr && limits->shouldStop()) return false;
     
-    // Get the empty cell
-    Node* emptyCell = sudokuGraph.getNodeByPosition(emptyRow, emptyCol);
+    // Branch on the most constrained empty cell (MRV)
+    int cell = queue.peekMostConstrained();
+    Node* emptyCell = queue.getCell(cell);
     
     // Create a binary tree to track possible values
     binaryTree domain;
     domain.initialize();
     
     // Remove values that are already used by neighbors
-    Edge* edge = emptyCell->getEdgeList();
-    while (edge != nullptr) {
-        Node* neighbor = edge->getDestination();
-        int neighborValue = neighbor->getValue();
+    for (int i = 0; i < emptyCell->getPeerCount(); i++) {
+        int neighborValue = emptyCell->getPeer(i)->getValue();
         if (neighborValue != 0) {
             domain.remove(neighborValue);
         }
-        edge = edge->getNext();
     }
     
     // Try each possible value
@@ -166,14 +207,17 @@ bool solveWithBinaryTree(Graph& sudokuGraph) {
         
         if (sudokuGraph.isValidSudokuValue(emptyCell, value)) {
             emptyCell->setValue(value);
+            queue.assigned(cell);
+            if (stats != nullptr) stats->nodes++;
             
             // Recursively solve the rest of the puzzle
-            if (solveWithBinaryTree(sudokuGraph)) {
+            if (solveWithBinaryTree(sudokuGraph, queue, stats, limits)) {
                 return true;
             }
             
             // If we get here, this value didn't work
             emptyCell->setValue(0);
+            queue.unassigned(cell);
         }
     }
     
@@ -181,83 +225,247 @@ bool solveWithBinaryTree(Graph& sudokuGraph) {
     return false;
 }
 
-// New function to handle file content directly (for web uploads)
-bool readSudokuFromString(const std::string& content, Graph& sudokuGraph) {
-    std::istringstream inputStream(content);
+// Alternative solver using recursion and the binary tree for domain tracking
+bool solveWithBinaryTree(Graph& sudokuGraph, SearchStats* stats = nullptr, const SearchLimits* limits = nullptr) {
+    CellQueue queue(sudokuGraph);
+    return solveWithBinaryTree(sudokuGraph, queue, stats, limits);
+}
+
+// Exact-cover solver using Dancing Links (Algorithm X)
+// One exact-cover arena per thread, reused for every puzzle
+DancingLinks& threadDancingLinks() {
+    static thread_local DancingLinks dlx;
+    return dlx;
+}
+
+void graphToGrid(Graph& sudokuGraph, int grid[81]) {
+    for (int cell = 0; cell < 81; cell++) {
+        grid[cell] = sudokuGraph.getValueAt(cell);
+    }
+}
+
+bool solveWithDancingLinks(Graph& sudokuGraph, SearchStats* stats = nullptr, const SearchLimits* limits = nullptr) {
+    int grid[81];
+    graphToGrid(sudokuGraph, grid);
     
-    // Build the graph structure for Sudoku
-    sudokuGraph.buildSudokuConstraints();
+    DancingLinks& dlx = threadDancingLinks();
+    bool solved = dlx.solve(grid, limits);
+    if (stats != nullptr) stats->nodes += dlx.getSearchNodes();
+    if (!solved) {
+        return false;
+    }
     
-    std::string line;
-    int row = 0;
+    for (int cell = 0; cell < 81; cell++) {
+        sudokuGraph.setValueAt(cell, grid[cell]);
+    }
+    return true;
+}
+
+// Count the solutions of the puzzle, stopping as soon as limit of them have
+// been found; limit = 2 decides uniqueness. Runs on the exact-cover search
+// (the fastest backend) and leaves the graph unchanged.
+int countSolutions(Graph& sudokuGraph, int limit, SearchStats* stats = nullptr, const SearchLimits* limits = nullptr) {
+    int grid[81];
+    graphToGrid(sudokuGraph, grid);
     
-    while (std::getline(inputStream, line) && row < 9) {
-        int col = 0;
-        for (size_t i = 0; i < line.length() && col < 9; i++) {
-            if (line[i] == ',' || line[i] == ' ') {
-                continue; // Skip commas and spaces
+    DancingLinks& dlx = threadDancingLinks();
+    int count = dlx.countSolutions(grid, limit, limits);
+    if (stats != nullptr) stats->nodes += dlx.getSearchNodes();
+    return count;
+}
+
+// Constraint propagation (naked/hidden singles) with branching only on stalls
+template <int Order>
+bool solveWithPropagation(BasicGraph<Order>& sudokuGraph, SearchStats* stats = nullptr, const SearchLimits* limits = nullptr) {
+    BasicConstraintPropagator<Order> propagator(sudokuGraph);
+    bool solved = propagator.solve(limits);
+    if (stats != nullptr) {
+        stats->nodes += propagator.getSearchNodes();
+        stats->guesses += propagator.getGuesses();
+    }
+    return solved;
+}
+
+// Solver backends selectable with --solver
+typedef bool (*SolverFunction)(Graph& sudokuGraph, SearchStats* stats, const SearchLimits* limits);
+
+struct SolverEntry {
+    const char* name;
+    SolverFunction solve;
+};
+
+const SolverEntry solvers[] = {
+    {"backtrack", solveSudoku<3>},
+    {"tree", solveWithBinaryTree},
+    {"dlx", solveWithDancingLinks},
+    {"propagate", solveWithPropagation<3>}
+};
+
+SolverFunction findSolver(const std::string& name) {
+    for (const SolverEntry& entry : solvers) {
+        if (name == entry.name) {
+            return entry.solve;
+        }
+    }
+    return nullptr;
+}
+
+// Parallel search for a single hard puzzle. The first branch points of the
+// search tree (most constrained cell first) are expanded breadth-first into
+// independent subproblems, which run concurrently on the pool, each on a
+// worker-owned graph. The first worker to find a solution cancels the rest
+// through the shared SearchLimits, which also follow the caller's limits.
+// Must not be called from a worker of pool.
+bool solveInParallel(Graph& sudokuGraph, SolverFunction solve, ThreadPool& pool, SearchStats* stats = nullptr, const SearchLimits* outer = nullptr) {
+    struct Subproblem {
+        int grid[81];
+    };
+    
+    std::vector<Subproblem> frontier(1);
+    for (int cell = 0; cell < 81; cell++) {
+        frontier[0].grid[cell] = sudokuGraph.getValueAt(cell);
+    }
+    
+    // Split until there are a few subproblems per worker
+    const size_t target = static_cast<size_t>(pool.getThreadCount()) * 8;
+    const int maxDepth = 8;
+    Graph scratch;
+    scratch.buildSudokuConstraints();
+    
+    for (int depth = 0; depth < maxDepth && frontier.size() > 0 && frontier.size() < target; depth++) {
+        std::vector<Subproblem> next;
+        
+        for (const Subproblem& subproblem : frontier) {
+            for (int cell = 0; cell < 81; cell++) {
+                scratch.setValueAt(cell, subproblem.grid[cell]);
             }
             
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
-            if (cell == nullptr) {
-                std::cerr << "Error: Invalid cell position (" << row << "," << col << ")" << std::endl;
-                return false;
+            int best = -1, bestCount = 10, bestMask = 0;
+            for (int cell = 0; cell < 81 && bestCount > 0; cell++) {
+                if (scratch.getValueAt(cell) == 0) {
+                    int mask = scratch.getCandidateMaskAt(cell);
+                    int count = countCandidates(mask);
+                    if (count < bestCount) {
+                        best = cell;
+                        bestCount = count;
+                        bestMask = mask;
+                    }
+                }
             }
             
-            if (line[i] >= '1' && line[i] <= '9') {
-                int value = line[i] - '0';
-                cell->setValue(value);
-            } else if (line[i] == '*' || line[i] == '0' || line[i] == '.') {
-                cell->setValue(0); // Empty cell
-            } else {
-                std::cerr << "Error: Invalid character in input: " << line[i] << std::endl;
-                return false;
+            if (best == -1) {
+                next.push_back(subproblem); // Already complete
+                continue;
             }
             
-            col++;
-        }
-        
-        if (col < 9) {
-            std::cerr << "Error: Row " << row << " has fewer than 9 columns" << std::endl;
-            return false;
+            // One child per candidate; a cell without candidates is a dead end
+            for (int mask = bestMask; mask != 0; mask &= mask - 1) {
+                Subproblem child = subproblem;
+                child.grid[best] = __builtin_ctz(mask) + 1;
+                next.push_back(child);
+            }
         }
-        
-        row++;
+        frontier.swap(next);
+    }
+    
+    if (frontier.empty()) {
+        return false;
+    }
+    
+    std::vector<Graph> graphs(pool.getThreadCount());
+    for (Graph& graph : graphs) {
+        graph.buildSudokuConstraints();
+    }
+    
+    std::atomic<bool> cancel(false);
+    SearchLimits limits;
+    limits.cancel = &cancel;
+    limits.parent = outer;
+    
+    std::mutex resultMutex;
+    std::condition_variable allDone;
+    size_t remaining = frontier.size();
+    bool found = false;
+    int solution[81];
+    std::atomic<long long> nodes(0);
+    
+    for (size_t i = 0; i < frontier.size(); i++) {
+        pool.submit([&, i](int worker) {
+            if (!limits.shouldStop()) {
+                Graph& graph = graphs[worker];
+                for (int cell = 0; cell < 81; cell++) {
+                    graph.setValueAt(cell, frontier[i].grid[cell]);
+                }
+                
+                SearchStats local;
+                if (solve(graph, &local, &limits)) {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (!found) {
+                        found = true;
+                        for (int cell = 0; cell < 81; cell++) {
+                            solution[cell] = graph.getValueAt(cell);
+                        }
+                        cancel = true;
+                    }
+                }
+                nodes += local.nodes;
+            }
+            
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (--remaining == 0) {
+                allDone.notify_all();
+            }
+        });
     }
     
-    if (row < 9) {
-        std::cerr << "Error: Input has fewer than 9 rows" << std::endl;
+    std::unique_lock<std::mutex> lock(resultMutex);
+    allDone.wait(lock, [&]() { return remaining == 0; });
+    
+    if (stats != nullptr) stats->nodes += nodes.load();
+    if (!found) {
         return false;
     }
     
+    for (int cell = 0; cell < 81; cell++) {
+        sudokuGraph.setValueAt(cell, solution[cell]);
+    }
     return true;
 }
 
+// New function to handle file content directly (for web uploads)
+template <int Order>
+bool readSudokuFromString(const std::string& content, BasicGraph<Order>& sudokuGraph) {
+    std::istringstream inputStream(content);
+    return readSudokuFromStream(inputStream, sudokuGraph);
+}
+
 // New function to load Sudoku from a 2D vector (for direct GUI input)
-bool loadSudokuFromGrid(const std::vector<std::vector<int>>& grid, Graph& sudokuGraph) {
-    if (grid.size() != 9) {
-        std::cerr << "Error: Grid must have 9 rows" << std::endl;
+template <int Order>
+bool loadSudokuFromGrid(const std::vector<std::vector<int>>& grid, BasicGraph<Order>& sudokuGraph) {
+    const int side = BoardTraits<Order>::SIDE;
+    if (grid.size() != static_cast<size_t>(side)) {
+        std::cerr << "Error: Grid must have " << side << " rows" << std::endl;
         return false;
     }
     
     // Build the graph structure for Sudoku
     sudokuGraph.buildSudokuConstraints();
     
-    for (int row = 0; row < 9; row++) {
-        if (grid[row].size() != 9) {
-            std::cerr << "Error: Row " << row << " must have 9 columns" << std::endl;
+    for (int row = 0; row < side; row++) {
+        if (grid[row].size() != static_cast<size_t>(side)) {
+            std::cerr << "Error: Row " << row << " must have " << side << " columns" << std::endl;
             return false;
         }
         
-        for (int col = 0; col < 9; col++) {
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
+        for (int col = 0; col < side; col++) {
+            BasicNode<Order>* cell = sudokuGraph.getNodeByPosition(row, col);
             if (cell == nullptr) {
                 std::cerr << "Error: Invalid cell position (" << row << "," << col << ")" << std::endl;
                 return false;
             }
             
             int value = grid[row][col];
-            if (value < 0 || value > 9) {
+            if (value < 0 || value > side) {
                 std::cerr << "Error: Invalid value " << value << " at position (" << row << "," << col << ")" << std::endl;
                 return false;
             }
@@ -269,86 +477,1000 @@ bool loadSudokuFromGrid(const std::vector<std::vector<int>>& grid, Graph& sudoku
     return true;
 }
 
+// Parse a puzzle in the one-line format (81 characters, row-major; digits
+// for givens and '0', '.' or '*' for empty cells) into grid
+bool parseSudokuLine(const std::string& line, int grid[81]) {
+    size_t length = line.length();
+    while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ' || line[length - 1] == '\t')) {
+        length--;
+    }
+    if (length != 81) {
+        return false;
+    }
+    
+    for (int cell = 0; cell < 81; cell++) {
+        char ch = line[cell];
+        if (ch >= '1' && ch <= '9') {
+            grid[cell] = ch - '0';
+        } else if (ch == '0' || ch == '.' || ch == '*') {
+            grid[cell] = 0;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Load a puzzle in the one-line format. The graph must already be built, so
+// it can be reused across puzzles; every cell is overwritten.
+bool loadSudokuFromLine(const std::string& line, Graph& sudokuGraph) {
+    int grid[81];
+    if (!parseSudokuLine(line, grid)) {
+        return false;
+    }
+    
+    for (int cell = 0; cell < 81; cell++) {
+        sudokuGraph.setValueAt(cell, grid[cell]);
+    }
+    return true;
+}
+
+// Result of one batch line
+enum BatchResult { BATCH_SOLVED, BATCH_UNSOLVABLE, BATCH_INVALID, BATCH_TIMED_OUT };
+
+// Solve one puzzle line on a built graph and append the output line
+BatchResult solveBatchLine(const std::string& line, Graph& sudokuGraph, SolverFunction solve, std::string& output,
+                           const SearchLimits* limits = nullptr) {
+    if (!loadSudokuFromLine(line, sudokuGraph)) {
+        output += "invalid\n";
+        return BATCH_INVALID;
+    }
+    
+    // Clashing givens have no solution; the backtracking solvers would
+    // search the whole tree to find that out
+    if (sudokuGraph.hasConflicts()) {
+        output += "no solution\n";
+        return BATCH_UNSOLVABLE;
+    }
+    
+    // Once the batch is out of time the remaining lines are not started
+    if (limits != nullptr && limits->expired()) {
+        output += "timeout\n";
+        return BATCH_TIMED_OUT;
+    }
+    
+    if (!solve(sudokuGraph, nullptr, limits)) {
+        if (limits != nullptr && limits->expired()) {
+            output += "timeout\n";
+            return BATCH_TIMED_OUT;
+        }
+        output += "no solution\n";
+        return BATCH_UNSOLVABLE;
+    }
+    
+    char solution[82];
+    for (int cell = 0; cell < 81; cell++) {
+        solution[cell] = static_cast<char>('0' + sudokuGraph.getValueAt(cell));
+    }
+    solution[81] = '\n';
+    output.append(solution, sizeof(solution));
+    return BATCH_SOLVED;
+}
+
+bool isBatchPuzzleLine(const std::string& line) {
+    return !line.empty() && line[0] != '#' && line != "\r"; // Skip blank lines and comments
+}
+
+// Counters shared by the batch modes
+struct BatchTotals {
+    long long total = 0;
+    long long solved = 0;
+    long long invalid = 0;
+    
+    void add(BatchResult result) {
+        total++;
+        if (result == BATCH_SOLVED) solved++;
+        if (result == BATCH_INVALID) invalid++;
+    }
+};
+
+// Solve consecutive batch lines and append their output lines in order.
+// With lockstep, each group of puzzles is first propagated together, one
+// puzzle per SIMD lane; only the lines propagation cannot finish (needing a
+// guess, unsolvable or invalid) go through solveBatchLine.
+void solveBatchLines(const std::vector<std::string>& lines, Graph& sudokuGraph, SolverFunction solve, bool lockstep,
+                     std::string& output, BatchTotals& totals, const SearchLimits* limits = nullptr) {
+    if (!lockstep) {
+        for (const std::string& line : lines) {
+            totals.add(solveBatchLine(line, sudokuGraph, solve, output, limits));
+        }
+        return;
+    }
+    
+    static thread_local LockstepSolver lanes;
+    const size_t laneCount = static_cast<size_t>(lanes.getLaneCount());
+    int grid[81];
+    
+    for (size_t first = 0; first < lines.size(); first += laneCount) {
+        size_t count = std::min(lines.size() - first, laneCount);
+        lanes.clear();
+        for (size_t lane = 0; lane < count; lane++) {
+            if (parseSudokuLine(lines[first + lane], grid)) {
+                lanes.load(static_cast<int>(lane), grid);
+            }
+        }
+        
+        unsigned solved = lanes.propagate();
+        for (size_t lane = 0; lane < count; lane++) {
+            if ((solved >> lane) & 1) {
+                char solution[82];
+                lanes.getSolution(static_cast<int>(lane), grid);
+                for (int cell = 0; cell < 81; cell++) {
+                    solution[cell] = static_cast<char>('0' + grid[cell]);
+                }
+                solution[81] = '\n';
+                output.append(solution, sizeof(solution));
+                totals.add(BATCH_SOLVED);
+            } else {
+                totals.add(solveBatchLine(lines[first + lane], sudokuGraph, solve, output, limits));
+            }
+        }
+    }
+}
+
+// Work unit of the parallel batch mode: a run of consecutive puzzle lines
+struct BatchChunk {
+    std::vector<std::string> lines;
+    std::string output;
+    BatchTotals totals;
+};
+
+// Parallel batch mode: chunks of lines are solved on a work-stealing pool,
+// each worker on its own graph, and written back in input order through a
+// reorder buffer. At most a few chunks per worker are in flight at once.
+BatchTotals runParallelBatch(std::istream& input, std::ostream& output, SolverFunction solve, int threadCount, bool lockstep) {
+    const size_t chunkSize = 256;
+    
+    ThreadPool pool(threadCount);
+    const long long maxInFlight = pool.getThreadCount() * 4;
+    
+    std::vector<Graph> graphs(pool.getThreadCount());
+    for (Graph& graph : graphs) {
+        graph.buildSudokuConstraints();
+    }
+    
+    std::mutex reorderMutex;
+    std::condition_variable chunkFinished;
+    std::map<long long, std::shared_ptr<BatchChunk>> reorderBuffer;
+    long long nextSequence = 0;
+    long long nextToWrite = 0;
+    BatchTotals totals;
+    
+    // Write the next chunk in input order; returns false if it is not ready
+    auto writeNext = [&](bool block) {
+        std::shared_ptr<BatchChunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(reorderMutex);
+            if (block) {
+                chunkFinished.wait(lock, [&]() { return reorderBuffer.count(nextToWrite) != 0; });
+            }
+            std::map<long long, std::shared_ptr<BatchChunk>>::iterator it = reorderBuffer.find(nextToWrite);
+            if (it == reorderBuffer.end()) {
+                return false;
+            }
+            chunk = it->second;
+            reorderBuffer.erase(it);
+        }
+        
+        output.write(chunk->output.data(), chunk->output.size());
+        totals.total += chunk->totals.total;
+        totals.solved += chunk->totals.solved;
+        totals.invalid += chunk->totals.invalid;
+        nextToWrite++;
+        return true;
+    };
+    
+    std::string line;
+    bool more = true;
+    while (more) {
+        std::shared_ptr<BatchChunk> chunk(new BatchChunk());
+        while (chunk->lines.size() < chunkSize && (more = static_cast<bool>(std::getline(input, line)))) {
+            if (isBatchPuzzleLine(line)) {
+                chunk->lines.push_back(line);
+            }
+        }
+        if (chunk->lines.empty()) {
+            break;
+        }
+        
+        // Bound memory: wait for the oldest chunks before reading further
+        while (nextSequence - nextToWrite >= maxInFlight) {
+            writeNext(true);
+        }
+        
+        long long sequence = nextSequence++;
+        pool.submit([&, chunk, sequence](int worker) {
+            solveBatchLines(chunk->lines, graphs[worker], solve, lockstep, chunk->output, chunk->totals);
+            
+            std::lock_guard<std::mutex> lock(reorderMutex);
+            reorderBuffer[sequence] = chunk;
+            chunkFinished.notify_one();
+        });
+        
+        while (writeNext(false)) {
+        }
+    }
+    
+    while (nextToWrite < nextSequence) {
+        writeNext(true);
+    }
+    return totals;
+}
+
+// Solve a batch of lines held in memory (the GUI server's batch endpoint) on
+// a shared pool: runs of lines are solved concurrently, each on a graph of
+// the batch, and their output lines are joined in input order. Returns once
+// the whole batch is done; tasks of other callers may share the pool.
+BatchTotals solveLinesInParallel(const std::vector<std::string>& lines, SolverFunction solve, ThreadPool& pool, bool lockstep,
+                                 const SearchLimits* limits, std::string& output) {
+    // Small runs, so a batch of a few hundred puzzles still spreads out
+    const size_t chunkSize = 64;
+    const size_t chunkCount = (lines.size() + chunkSize - 1) / chunkSize;
+    
+    std::vector<BatchChunk> chunks(chunkCount);
+    for (size_t i = 0; i < chunkCount; i++) {
+        size_t first = i * chunkSize;
+        chunks[i].lines.assign(lines.begin() + first, lines.begin() + std::min(lines.size(), first + chunkSize));
+    }
+    
+    std::vector<Graph> graphs(pool.getThreadCount());
+    for (Graph& graph : graphs) {
+        graph.buildSudokuConstraints();
+    }
+    
+    std::mutex doneMutex;
+    std::condition_variable allDone;
+    size_t remaining = chunkCount;
+    
+    for (size_t i = 0; i < chunkCount; i++) {
+        pool.submit([&, i](int worker) {
+            solveBatchLines(chunks[i].lines, graphs[worker], solve, lockstep, chunks[i].output, chunks[i].totals, limits);
+            
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) {
+                allDone.notify_all();
+            }
+        });
+    }
+    
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        allDone.wait(lock, [&]() { return remaining == 0; });
+    }
+    
+    BatchTotals totals;
+    for (const BatchChunk& chunk : chunks) {
+        output += chunk.output;
+        totals.total += chunk.totals.total;
+        totals.solved += chunk.totals.solved;
+        totals.invalid += chunk.totals.invalid;
+    }
+    return totals;
+}
+
+// Batch mode: solve one puzzle per input line and stream one output line per
+// puzzle (the 81-digit solution, "no solution" or "invalid"). Memory stays
+// bounded by the lines in flight, and graphs are built once and reused.
+// With lockstep, puzzles are propagated a SIMD batch at a time first.
+int runBatch(std::istream& input, std::ostream& output, SolverFunction solve, int threadCount, bool lockstep) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    BatchTotals totals;
+    
+    if (threadCount == 1) {
+        Graph sudokuGraph;
+        sudokuGraph.buildSudokuConstraints();
+        
+        // Without lockstep every line is answered as soon as it is read
+        const size_t groupSize = lockstep ? LockstepSolver::MAX_LANES : 1;
+        std::vector<std::string> group;
+        std::string line;
+        std::string result;
+        bool more = true;
+        while (more) {
+            more = static_cast<bool>(std::getline(input, line));
+            if (more && isBatchPuzzleLine(line)) {
+                group.push_back(line);
+            }
+            if (group.size() == groupSize || (!more && !group.empty())) {
+                result.clear();
+                solveBatchLines(group, sudokuGraph, solve, lockstep, result, totals);
+                output.write(result.data(), result.size());
+                group.clear();
+            }
+        }
+    } else {
+        totals = runParallelBatch(input, output, solve, threadCount, lockstep);
+    }
+    output.flush();
+    
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cerr << "Solved " << totals.solved << " of " << totals.total << " puzzles (" << totals.invalid << " invalid) in "
+              << seconds << " s, " << (seconds > 0 ? totals.total / seconds : 0) << " puzzles/s" << std::endl;
+    return 0;
+}
+
+// Solve a puzzle file on a larger board (--size 16 or 25). Only the generic
+// backends (backtrack and propagate) are available for these orders.
+template <int Order>
+int solveBoardFile(const std::string& inputFile, const std::string& solverName) {
+    typedef bool (*BoardSolver)(BasicGraph<Order>&, SearchStats*, const SearchLimits*);
+    BoardSolver solve = nullptr;
+    if (solverName == "backtrack") {
+        solve = solveSudoku<Order>;
+    } else if (solverName == "propagate") {
+        solve = solveWithPropagation<Order>;
+    } else {
+        std::cerr << "Error: Solver " << solverName << " only supports 9x9 boards (use backtrack or propagate)" << std::endl;
+        return 1;
+    }
+    
+    BasicGraph<Order> sudokuGraph;
+    if (!readSudokuFromFile(inputFile, sudokuGraph)) {
+        std::cerr << "Failed to read Sudoku puzzle from file." << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Initial Sudoku puzzle:" << std::endl;
+    sudokuGraph.printSudokuGrid();
+    
+    std::cout << "\nSolving..." << std::endl;
+    SearchStats stats;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool solved = !sudokuGraph.hasConflicts() && solve(sudokuGraph, &stats, nullptr);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Search nodes: " << stats.nodes << " (" << elapsed << " ms)" << std::endl;
+    
+    if (solved) {
+        std::cout << "\nSolved Sudoku puzzle:" << std::endl;
+        sudokuGraph.printSudokuGrid();
+    } else {
+        std::cout << "\nNo solution exists for this Sudoku puzzle." << std::endl;
+    }
+    return 0;
+}
+
+// Generate count unique-solution puzzles with the given clue target, one
+// 81-character line each. Puzzle i is generated from seed + i, so the output
+// only depends on the seed, not on the number of threads.
+int runGenerator(std::ostream& output, long long count, int clues, unsigned long long seed, int threadCount) {
+    using Clock = std::chrono::steady_clock;
+    const long long chunkSize = 64;
+    
+    ThreadPool pool(threadCount);
+    const long long roundSize = chunkSize * pool.getThreadCount() * 4;
+    std::vector<std::string> lines;
+    
+    Clock::time_point start = Clock::now();
+    for (long long first = 0; first < count; first += roundSize) {
+        long long last = std::min(count, first + roundSize);
+        lines.assign(static_cast<size_t>(last - first), std::string());
+        
+        for (long long chunk = first; chunk < last; chunk += chunkSize) {
+            pool.submit([&, chunk](int) {
+                dynamicArray generator;
+                long long end = std::min(last, chunk + chunkSize);
+                for (long long i = chunk; i < end; i++) {
+                    generator.seed(seed + static_cast<unsigned long long>(i));
+                    generator.generate(clues);
+                    std::string& line = lines[static_cast<size_t>(i - first)];
+                    line = generator.to_line();
+                    line += '\n';
+                }
+            });
+        }
+        pool.wait();
+        
+        for (const std::string& line : lines) {
+            output.write(line.data(), line.size());
+        }
+    }
+    output.flush();
+    
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cerr << "Generated " << count << " puzzles in " << seconds << " s, "
+              << (seconds > 0 ? count / seconds : 0) << " puzzles/s" << std::endl;
+    return 0;
+}
+
+// Cache misses per unit of work, "n/a" when the counter is unavailable
+std::string formatMisses(long long missCount, long long units) {
+    if (missCount < 0) {
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << static_cast<double>(missCount) / units;
+    return out.str();
+}
+
+// Sweep the value and candidates of every cell of many boards, once through
+// the Node objects (the pointer-chasing path the solvers used to take) and
+// once through the graph's per-cell arrays. The boards together are larger
+// than the L2 cache, so the sweeps measure memory traffic rather than ALU.
+void runLayoutBenchmark(CacheMissCounter& misses) {
+    using Clock = std::chrono::steady_clock;
+    const int boardCount = 2048;
+    const int sweeps = 20;
+    
+    std::vector<Graph> boards(boardCount);
+    for (Graph& board : boards) {
+        board.buildSudokuConstraints();
+        if (!readSudokuFromFile("sample_sudoku_H.txt", board)) {
+            std::cout << "Layout sweep: sample_sudoku_H.txt not found, skipped" << std::endl;
+            return;
+        }
+    }
+    
+    const long long cellVisits = 81LL * boardCount * sweeps;
+    long long checksums[2] = {0, 0};
+    const char* names[2] = {"node objects", "cell arrays"};
+    
+    for (int layout = 0; layout < 2; layout++) {
+        misses.start();
+        Clock::time_point start = Clock::now();
+        long long checksum = 0;
+        for (int sweep = 0; sweep < sweeps; sweep++) {
+            for (const Graph& board : boards) {
+                for (int cell = 0; cell < 81; cell++) {
+                    if (layout == 0) {
+                        const Node* node = board.getNodeByPosition(cell / 9, cell % 9);
+                        checksum += node->getValue() + countCandidates(node->getDomainMask());
+                    } else {
+                        checksum += board.getValueAt(cell) + countCandidates(board.getDomainAt(cell));
+                    }
+                }
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        long long missCount = misses.stop();
+        checksums[layout] = checksum;
+        
+        std::cout << "Layout sweep [" << names[layout] << "]: " << elapsed / cellVisits << " ns/cell, "
+                  << formatMisses(missCount, cellVisits) << " misses/cell" << std::endl;
+    }
+    
+    if (checksums[0] != checksums[1]) {
+        std::cout << "Layout sweep: MISMATCH" << std::endl;
+    }
+}
+
+// Time every 9x9 candidate kernel the CPU supports on the hard sample and
+// check each against the scalar one
+void runCandidateScanBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    const int scans = 200000;
+    
+    Graph board;
+    if (!readSudokuFromFile("sample_sudoku_H.txt", board)) {
+        std::cout << "Candidate scan: sample_sudoku_H.txt not found, skipped" << std::endl;
+        return;
+    }
+    
+    std::string selected = getCandidateKernel();
+    CandidateScan<3> reference;
+    setCandidateKernel("scalar");
+    scanCandidates(board, reference);
+    
+    const char* names[] = {"avx2", "sse2", "scalar"};
+    for (const char* name : names) {
+        if (!setCandidateKernel(name)) {
+            std::cout << "Candidate scan [" << name << "]: not supported" << std::endl;
+            continue;
+        }
+        
+        CandidateScan<3> scan;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < scans; i++) {
+            scanCandidates(board, scan);
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        
+        int singles = 0;
+        for (int cell = 0; cell < 81; cell++) {
+            singles += static_cast<int>((scan.singles[cell / 64] >> (cell % 64)) & 1);
+        }
+        
+        bool matches = std::memcmp(scan.masks, reference.masks, sizeof(scan.masks)) == 0
+                    && std::memcmp(scan.singles, reference.singles, sizeof(scan.singles)) == 0
+                    && std::memcmp(scan.blocked, reference.blocked, sizeof(scan.blocked)) == 0;
+        std::cout << "Candidate scan [" << name << "]: " << elapsed / scans << " ns/board, "
+                  << singles << " naked singles" << (matches ? "" : " (MISMATCH)") << std::endl;
+    }
+    
+    setCandidateKernel(selected);
+}
+
+// Throughput of lock-step propagation against one propagation solve per
+// puzzle, on full batches of each sample
+void runLockstepBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    const int puzzles = 20000;
+    
+    LockstepSolver lanes;
+    const int laneCount = lanes.getLaneCount();
+    const char* samples[] = {"sample_sudoku_S.txt", "sample_sudoku_M.txt", "sample_sudoku_H.txt"};
+    for (const char* sample : samples) {
+        Graph graph;
+        if (!readSudokuFromFile(sample, graph)) {
+            continue;
+        }
+        int grid[81];
+        graphToGrid(graph, grid);
+        
+        unsigned solved = 0;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < puzzles; i += laneCount) {
+            for (int lane = 0; lane < laneCount; lane++) {
+                lanes.load(lane, grid);
+            }
+            solved = lanes.propagate();
+        }
+        double lockstepTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        
+        start = Clock::now();
+        for (int i = 0; i < puzzles; i++) {
+            for (int cell = 0; cell < 81; cell++) {
+                graph.setValueAt(cell, grid[cell]);
+            }
+            ConstraintPropagator propagator(graph);
+            propagator.solve();
+        }
+        double scalarTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        
+        std::cout << sample << " [lockstep " << lanes.getKernelName() << " x" << laneCount << "]: "
+                  << lockstepTime / puzzles << " us/puzzle vs " << scalarTime / puzzles << " us/puzzle propagate"
+                  << (solved != 0 ? "" : " (needs branching)") << std::endl;
+    }
+}
+
+// Cost of the GUI server's wire formats for one grid: the nested JSON arrays
+// of the grid messages, a JSON 81-digit string as in batch responses, and
+// the packed binary grid. Each encodes from the graph's cell values and
+// decodes back to a grid.
+void runWireFormatBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    using json = nlohmann::json;
+    const int runs = 20000;
+    
+    Graph graph;
+    if (!readSudokuFromFile("sample_sudoku_H.txt", graph) || !solveSudoku(graph)) {
+        std::cout << "Wire format: sample_sudoku_H.txt not found, skipped" << std::endl;
+        return;
+    }
+    
+    const char* names[] = {"json rows", "json string", "binary"};
+    for (int format = 0; format < 3; format++) {
+        std::string encoded;
+        size_t bytes = 0;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < runs; i++) {
+            if (format == 0) {
+                json rows = json::array();
+                for (int row = 0; row < 9; row++) {
+                    json rowJson = json::array();
+                    for (int col = 0; col < 9; col++) {
+                        rowJson.push_back(graph.getValueAt(row * 9 + col));
+                    }
+                    rows.push_back(rowJson);
+                }
+                encoded = rows.dump();
+            } else if (format == 1) {
+                encoded.assign(1, '"');
+                for (int cell = 0; cell < 81; cell++) {
+                    encoded += static_cast<char>('0' + graph.getValueAt(cell));
+                }
+                encoded += '"';
+            } else {
+                int grid[81];
+                unsigned char packed[PACKED_GRID_SIZE];
+                graphToGrid(graph, grid);
+                packGrid(grid, packed);
+                encoded.assign(reinterpret_cast<const char*>(packed), sizeof(packed));
+            }
+            bytes += encoded.size();
+        }
+        double encodeTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        
+        int grid[81] = {0};
+        bool decoded = true;
+        start = Clock::now();
+        for (int i = 0; i < runs; i++) {
+            if (format == 0) {
+                json rows = json::parse(encoded);
+                for (int cell = 0; cell < 81; cell++) {
+                    grid[cell] = rows[cell / 9][cell % 9].get<int>();
+                }
+            } else if (format == 1) {
+                std::string digits = json::parse(encoded).get<std::string>();
+                decoded = parseSudokuLine(digits, grid) && decoded;
+            } else {
+                decoded = unpackGrid(reinterpret_cast<const unsigned char*>(encoded.data()), grid) && decoded;
+            }
+        }
+        double decodeTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        
+        // The decoded grid must be the solution the encoding started from
+        for (int cell = 0; cell < 81; cell++) {
+            decoded = decoded && grid[cell] == graph.getValueAt(cell);
+        }
+        std::cout << "Wire format [" << names[format] << "]: " << bytes / runs << " bytes/grid, encode "
+                  << encodeTime / runs << " ns, decode " << decodeTime / runs << " ns"
+                  << (decoded ? "" : " (MISMATCH)") << std::endl;
+    }
+}
+
+// Micro-benchmark for the graph hot paths: building the constraint graph and
+// loading + solving the sample puzzles (run from the build directory)
+void runBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    const int constructionRuns = 2000;
+    const int solveRuns = 200;
+    CacheMissCounter misses;
+    
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < constructionRuns; i++) {
+        Graph graph;
+        graph.buildSudokuConstraints();
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    std::cout << "Graph construction: " << elapsed / constructionRuns << " us/graph" << std::endl;
+    
+    const char* samples[] = {"sample_sudoku_S.txt", "sample_sudoku_M.txt", "sample_sudoku_H.txt"};
+    for (const char* sample : samples) {
+        Graph reference;
+        if (!readSudokuFromFile(sample, reference)) {
+            std::cout << sample << ": not found, skipped" << std::endl;
+            continue;
+        }
+        bool referenceSolved = solveSudoku(reference);
+        
+        for (const SolverEntry& entry : solvers) {
+            misses.start();
+            start = Clock::now();
+            bool solved = true;
+            Graph graph;
+            SearchStats stats;
+            for (int i = 0; i < solveRuns; i++) {
+                graph = Graph();
+                stats = SearchStats();
+                solved = readSudokuFromFile(sample, graph) && entry.solve(graph, &stats, nullptr) && solved;
+            }
+            elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            long long missCount = misses.stop();
+            
+            // Every backend must agree with the backtracking solver
+            bool matches = solved == referenceSolved;
+            for (int row = 0; row < 9 && matches; row++) {
+                for (int col = 0; col < 9; col++) {
+                    if (graph.getNodeByPosition(row, col)->getValue() != reference.getNodeByPosition(row, col)->getValue()) {
+                        matches = false;
+                    }
+                }
+            }
+            
+            std::cout << sample << " [" << entry.name << "]: load + solve " << elapsed / solveRuns
+                      << " us/puzzle, " << stats.nodes << " nodes, "
+                      << formatMisses(missCount, solveRuns) << " misses/puzzle" << (solved ? "" : " (unsolved)")
+                      << (matches ? "" : " (MISMATCH)") << std::endl;
+        }
+    }
+    
+    runLayoutBenchmark(misses);
+    runCandidateScanBenchmark();
+    runLockstepBenchmark();
+    runWireFormatBenchmark();
+}
+
+// Time limit of a solve started from the frontend
+const std::chrono::milliseconds GUI_SOLVE_TIMEOUT(30000);
+
+// Time limit of a solution count; a count cut short is reported as "at least"
+const std::chrono::milliseconds GUI_COUNT_TIMEOUT(10000);
+
+// Solution counts run at once, and the most that may wait or run
+const int GUI_COUNT_WORKERS = 2;
+const int GUI_MAX_PENDING_COUNTS = 8;
+
+// Puzzle state of one GUI session
+struct GuiSession {
+    Graph graph;
+    bool puzzleLoaded = false;
+    long long solveJob = -1;    // Job started by the session's "solve" button
+};
+
 int main(int argc, char* argv[]) {
     // Check if we should run in GUI mode or CLI mode
     bool guiMode = false;
+    bool benchmarkMode = false;
     std::string inputFile;
+    std::string solverName = "backtrack";
+    std::string batchInput;
+    int threadCount = -1;
+    bool parallelMode = false;
+    bool lockstep = false;
+    int backlog = 128;  // Pending connections of the GUI server
+    int countLimit = 0; // > 0: count solutions instead of solving
+    long long generateCount = 0;
+    int clues = dynamicArray::MEDIUM;
+    unsigned long long seed = static_cast<unsigned long long>(std::time(nullptr));
+    int boardSize = 9;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--gui" || arg == "-g") {
             guiMode = true;
+        } else if (arg == "--benchmark") {
+            benchmarkMode = true;
+        } else if (arg == "--solver" && i + 1 < argc) {
+            solverName = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchInput = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]); // 0 = all hardware threads
+        } else if (arg == "--parallel") {
+            parallelMode = true;
+        } else if (arg == "--lockstep") {
+            lockstep = true;
+        } else if (arg == "--backlog" && i + 1 < argc) {
+            backlog = std::atoi(argv[++i]);
+        } else if (arg == "--count" && i + 1 < argc) {
+            countLimit = std::atoi(argv[++i]);
+            if (countLimit < 1) {
+                std::cerr << "Error: --count expects a limit of at least 1" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--unique") {
+            countLimit = 2;
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generateCount = std::atoll(argv[++i]);
+        } else if (arg == "--difficulty" && i + 1 < argc) {
+            std::string difficulty = argv[++i];
+            if (difficulty == "easy") {
+                clues = dynamicArray::EASY;
+            } else if (difficulty == "medium") {
+                clues = dynamicArray::MEDIUM;
+            } else if (difficulty == "hard") {
+                clues = dynamicArray::HARD;
+            } else {
+                clues = std::atoi(difficulty.c_str()); // Explicit clue count
+                if (clues < 17 || clues > 81) {
+                    std::cerr << "Error: --difficulty expects easy, medium, hard or a clue count (17-81)" << std::endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--size" && i + 1 < argc) {
+            boardSize = std::atoi(argv[++i]);
+            if (boardSize != 9 && boardSize != 16 && boardSize != 25) {
+                std::cerr << "Error: --size expects 9, 16 or 25" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
         } else if (!arg.empty() && arg[0] != '-') {
             inputFile = arg;
         }
     }
     
+    if (benchmarkMode) {
+        runBenchmark();
+        return 0;
+    }
+    
+    if (boardSize != 9) {
+        if (inputFile.empty()) {
+            std::cerr << "Error: --size " << boardSize << " needs an input file" << std::endl;
+            return 1;
+        }
+        return boardSize == 16 ? solveBoardFile<4>(inputFile, solverName) : solveBoardFile<5>(inputFile, solverName);
+    }
+    
+    if (generateCount > 0) {
+        std::ios::sync_with_stdio(false);
+        return runGenerator(std::cout, generateCount, clues, seed, threadCount < 0 ? 0 : threadCount);
+    }
+    
+    SolverFunction solve = findSolver(solverName);
+    if (solve == nullptr) {
+        std::cerr << "Error: Unknown solver " << solverName << " (expected backtrack, tree, dlx or propagate)" << std::endl;
+        return 1;
+    }
+    
+    if (!batchInput.empty()) {
+        std::ios::sync_with_stdio(false);
+        if (batchInput == "-") {
+            return runBatch(std::cin, std::cout, solve, threadCount < 0 ? 1 : threadCount, lockstep);
+        }
+        
+        std::ifstream batchFile(batchInput);
+        if (!batchFile.is_open()) {
+            std::cerr << "Error: Could not open file " << batchInput << std::endl;
+            return 1;
+        }
+        return runBatch(batchFile, std::cout, solve, threadCount < 0 ? 1 : threadCount, lockstep);
+    }
+    
     if (guiMode) {
         // GUI mode with WebSocket server
-        SudokuGuiIpc ipc(3000);
-        Graph sudokuGraph;
-        bool puzzleLoaded = false;
+        SudokuGuiIpc ipc(3000, backlog);
+        
+        // Every browser session has its own puzzle; the least recently used
+        // ones are dropped beyond the server's session limit
+        LruCache<GuiSession> sessions(SudokuGuiIpc::MAX_SESSIONS);
+        
+        // The callbacks run on the server's worker, job results arrive on
+        // the job workers and the file given on the command line is loaded
+        // here; all of them go through this lock
+        std::mutex sessionMutex;
+        
+        // Hard puzzles are split across all cores (or --threads N)
+        ThreadPool solverPool(threadCount < 0 ? 0 : threadCount);
+        
+        // Solves run as jobs on their own copy of the puzzle, so the server
+        // answers other requests meanwhile. A few jobs may run at once,
+        // each of them spread over the solver pool.
+        SolveJobs jobs([&](int grid[81], const SearchLimits& limits) {
+            Graph jobGraph;
+            jobGraph.buildSudokuConstraints();
+            for (int cell = 0; cell < 81; cell++) {
+                jobGraph.setValueAt(cell, grid[cell]);
+            }
+            
+            if (jobGraph.hasConflicts() || !solveInParallel(jobGraph, solve, solverPool, nullptr, &limits)) {
+                return false;
+            }
+            graphToGrid(jobGraph, grid);
+            return true;
+        }, 2);
+        ipc.setJobs(&jobs);
+        
+        jobs.setListener([&](const SolveJobs::Status& status) {
+            std::cout << "Job " << status.id << " " << SolveJobs::stateName(status.state)
+                      << " (" << status.elapsedMs << " ms)" << std::endl;
+            ipc.sendJobStatus(status);
+            
+            // The job of a session's "solve" button is also reported as the
+            // usual status and solution messages
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                GuiSession* session = sessions.find(status.owner);
+                if (session == nullptr || session->solveJob != status.id) {
+                    return;
+                }
+                session->solveJob = -1;
+            }
+            
+            if (status.state == SolveJobs::SOLVED) {
+                Graph solution;
+                solution.buildSudokuConstraints();
+                for (int cell = 0; cell < 81; cell++) {
+                    solution.setValueAt(cell, status.grid[cell]);
+                }
+                ipc.sendSolvingStatus(status.owner, true, "Puzzle solved successfully");
+                ipc.sendSudokuGrid(status.owner, solution, true);
+            } else if (status.state == SolveJobs::UNSOLVABLE) {
+                ipc.sendSolvingStatus(status.owner, false, "No solution exists for this puzzle");
+            } else if (status.state == SolveJobs::TIMED_OUT) {
+                ipc.sendSolvingStatus(status.owner, false, "Solving timed out");
+            } else {
+                ipc.sendSolvingStatus(status.owner, false, "Solving cancelled");
+            }
+        });
         
         // Set up callbacks
-        ipc.setOnFileUploaded([&](const std::string& filename, const std::string& content) {
-            std::cout << "Received file: " << filename << std::endl;
+        ipc.setOnFileUploaded([&](const std::string& name, const std::string& filename, const std::string& content) {
+            std::cout << "Received file: " << filename << " (session " << name << ")" << std::endl;
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            GuiSession& session = sessions.touch(name);
             
-            // Reset the graph
-            sudokuGraph = Graph();
+            // Reset the graph (nodes and topology are kept)
+            session.graph.clearValues();
             
             // Load the puzzle from the file content
-            if (readSudokuFromString(content, sudokuGraph)) {
-                puzzleLoaded = true;
+            if (readSudokuFromString(content, session.graph)) {
+                session.puzzleLoaded = true;
                 std::cout << "Puzzle loaded successfully" << std::endl;
                 
                 // Send the initial grid to the frontend
-                ipc.sendSudokuGrid(sudokuGraph);
+                ipc.sendSudokuGrid(name, session.graph);
             } else {
-                ipc.sendError("Failed to load puzzle from file");
+                ipc.sendError(name, "Failed to load puzzle from file");
             }
         });
         
-        ipc.setOnPuzzleReceived([&](const std::vector<std::vector<int>>& puzzle) {
-            std::cout << "Received puzzle from GUI" << std::endl;
+        ipc.setOnPuzzleReceived([&](const std::string& name, const std::vector<std::vector<int>>& puzzle) {
+            std::cout << "Received puzzle from GUI (session " << name << ")" << std::endl;
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            GuiSession& session = sessions.touch(name);
             
-            // Reset the graph
-            sudokuGraph = Graph();
+            // Reset the graph (nodes and topology are kept)
+            session.graph.clearValues();
             
             // Load the puzzle from the grid
-            if (loadSudokuFromGrid(puzzle, sudokuGraph)) {
-                puzzleLoaded = true;
+            if (loadSudokuFromGrid(puzzle, session.graph)) {
+                session.puzzleLoaded = true;
                 std::cout << "Puzzle loaded successfully" << std::endl;
                 
                 // Send the initial grid to the frontend
-                ipc.sendSudokuGrid(sudokuGraph);
+                ipc.sendSudokuGrid(name, session.graph);
             } else {
-                ipc.sendError("Failed to load puzzle from GUI");
+                ipc.sendError(name, "Failed to load puzzle from GUI");
             }
         });
         
-        ipc.setOnSolveRequested([&]() {
-            std::cout << "Solve requested" << std::endl;
+        ipc.setOnSolveRequested([&](const std::string& name) -> long long {
+            std::cout << "Solve requested (session " << name << ")" << std::endl;
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            GuiSession* session = sessions.find(name);
             
-            if (!puzzleLoaded) {
-                ipc.sendError("No puzzle loaded");
-                return;
+            if (session == nullptr || !session->puzzleLoaded) {
+                ipc.sendError(name, "No puzzle loaded");
+                return -1;
             }
             
-            // Create a copy of the original puzzle for display
-            Graph originalGraph = sudokuGraph;
-            
-            // Solve the puzzle
-            std::cout << "Solving..." << std::endl;
-            bool solved = solveSudoku(sudokuGraph);
+            // Solve a copy; the loaded puzzle stays as it is
+            int grid[81];
+            graphToGrid(session->graph, grid);
+            long long id = jobs.submit(grid, GUI_SOLVE_TIMEOUT, name);
+            if (id < 0) {
+                ipc.sendError(name, "Too many solve jobs, try again later");
+                return -1;
+            }
+            session->solveJob = id;
+            std::cout << "Solving as job " << id << "..." << std::endl;
+            return id;
+        });
+        
+        // Counts run on workers of their own, so a slow count never holds up
+        // the server's request worker and the other sessions behind it
+        ThreadPool countPool(GUI_COUNT_WORKERS);
+        std::atomic<int> pendingCounts(0);
+        
+        ipc.setOnCountRequested([&](const std::string& name, int limit) {
+            std::cout << "Solution count requested (limit " << limit << ", session " << name << ")" << std::endl;
+            int grid[81];
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                GuiSession* session = sessions.find(name);
+                
+                if (session == nullptr || !session->puzzleLoaded) {
+                    ipc.sendError(name, "No puzzle loaded");
+                    return;
+                }
+                graphToGrid(session->graph, grid);
+            }
             
-            if (solved) {
-                std::cout << "Puzzle solved successfully" << std::endl;
-                ipc.sendSolvingStatus(true, "Puzzle solved successfully");
-                ipc.sendSudokuGrid(sudokuGraph, true);
-            } else {
-                std::cout << "No solution exists for this puzzle" << std::endl;
-                ipc.sendSolvingStatus(false, "No solution exists for this puzzle");
+            if (pendingCounts.fetch_add(1) >= GUI_MAX_PENDING_COUNTS) {
+                pendingCounts--;
+                ipc.sendError(name, "Too many solution counts, try again later");
+                return;
             }
+            
+            // Count on a copy, so the session stays usable meanwhile
+            std::vector<int> puzzle(grid, grid + 81);
+            countPool.submit([&, name, limit, puzzle](int) {
+                SearchLimits limits;
+                limits.deadline = SearchLimits::Clock::now() + GUI_COUNT_TIMEOUT;
+                int count = threadDancingLinks().countSolutions(puzzle.data(), limit, &limits);
+                ipc.sendSolutionCount(name, count, limit, limits.expired());
+                pendingCounts--;
+            });
+        });
+        
+        // Batches are solved on the solver pool, a run of lines per task
+        ipc.setOnBatchRequested([&](const std::vector<std::string>& lines, std::chrono::milliseconds timeout, std::string& output) {
+            SearchLimits limits;
+            limits.deadline = SearchLimits::Clock::now() + timeout;
+            solveLinesInParallel(lines, solve, solverPool, lockstep, &limits, output);
         });
         
         // Start the WebSocket server
@@ -357,14 +1479,16 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        // If an input file was provided, load it
+        // If an input file was provided, load it into the default session
         if (!inputFile.empty()) {
-            if (readSudokuFromFile(inputFile, sudokuGraph)) {
-                puzzleLoaded = true;
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            GuiSession& session = sessions.touch("default");
+            if (readSudokuFromFile(inputFile, session.graph)) {
+                session.puzzleLoaded = true;
                 std::cout << "Puzzle loaded from file: " << inputFile << std::endl;
-                ipc.sendSudokuGrid(sudokuGraph);
+                ipc.sendSudokuGrid("default", session.graph);
             } else {
-                ipc.sendError("Failed to load puzzle from file: " + inputFile);
+                ipc.sendError("default", "Failed to load puzzle from file: " + inputFile);
             }
         }
         
@@ -379,7 +1503,9 @@ int main(int argc, char* argv[]) {
         }
         
         if (inputFile.empty()) {
-            std::cerr << "Usage: " << argv[0] << " <input_file> [--gui]" << std::endl;
+            std::cerr << "Usage: " << argv[0] << " <input_file> [--solver backtrack|tree|dlx|propagate] [--parallel] [--threads N] [--count N|--unique] [--size 9|16|25] [--gui [--backlog N]] [--benchmark]" << std::endl;
+            std::cerr << "       " << argv[0] << " --batch <puzzles_file|-> [--threads N] [--solver ...] [--lockstep]" << std::endl;
+            std::cerr << "       " << argv[0] << " --generate N [--difficulty easy|medium|hard|CLUES] [--seed S] [--threads N]" << std::endl;
             return 1;
         }
         
@@ -394,9 +1520,39 @@ int main(int argc, char* argv[]) {
         std::cout << "Initial Sudoku puzzle:" << std::endl;
         sudokuGraph.printSudokuGrid();
         
+        if (countLimit > 0) {
+            SearchStats stats;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            int count = countSolutions(sudokuGraph, countLimit, &stats);
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "\nSearch nodes: " << stats.nodes << " (" << elapsed << " ms)" << std::endl;
+            
+            if (count < countLimit) {
+                std::cout << "Solutions: " << count << std::endl;
+            } else {
+                std::cout << "Solutions: at least " << count << " (search stopped at the limit)" << std::endl;
+            }
+            if (countLimit > 1) {
+                std::cout << (count == 1 ? "The puzzle has a unique solution." : "The puzzle does not have a unique solution.") << std::endl;
+            }
+            return 0;
+        }
+        
         // Solve the puzzle
         std::cout << "\nSolving..." << std::endl;
-        bool solved = solveSudoku(sudokuGraph);
+        SearchStats stats;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool solved;
+        if (sudokuGraph.hasConflicts()) {
+            solved = false;
+        } else if (parallelMode) {
+            ThreadPool pool(threadCount < 0 ? 0 : threadCount);
+            solved = solveInParallel(sudokuGraph, solve, pool, &stats);
+        } else {
+            solved = solve(sudokuGraph, &stats, nullptr);
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Search nodes: " << stats.nodes << " (" << elapsed << " ms)" << std::endl;
         
         if (solved) {
             std::cout << "\nSolved Sudoku puzzle:" << std::endl;
@@ -0,0 +1,52 @@
+#ifndef SEARCHCONTROL_H
+#define SEARCHCONTROL_H
+
+#include <atomic>
+#include <chrono>
+
+// Search statistics reported by the solvers
+struct SearchStats {
+    long long nodes = 0;    // Values placed (search nodes visited)
+    long long guesses = 0;  // Branching decisions (propagation solver only)
+};
+
+// Cooperative limits polled by the solvers while they search. A stopped
+// solver unwinds and reports failure; the caller can tell the difference
+// from an unsolvable puzzle through shouldStop().
+struct SearchLimits {
+    typedef std::chrono::steady_clock Clock;
+
+    const std::atomic<bool>* cancel = nullptr;  // Stop as soon as this is set
+    Clock::time_point deadline = Clock::time_point::max();  // Stop once this has passed
+    const SearchLimits* parent = nullptr;       // Also stop when the enclosing search stops
+
+    bool shouldStop() const {
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (deadline != Clock::time_point::max()) {
+            // Reading the clock costs more than a search node, so it is read
+            // every 1024 polls. The cached time only lags, never runs ahead,
+            // and once past the deadline it stays past it.
+            static thread_local unsigned polls = 0;
+            static thread_local Clock::time_point now;
+            if ((++polls & 1023) == 0) {
+                now = Clock::now();
+            }
+            if (now >= deadline) {
+                return true;
+            }
+        }
+        return parent != nullptr && parent->shouldStop();
+    }
+
+    // True once the deadline (here or in a parent) has passed
+    bool expired() const {
+        if (deadline != Clock::time_point::max() && Clock::now() >= deadline) {
+            return true;
+        }
+        return parent != nullptr && parent->expired();
+    }
+};
+
+#endif
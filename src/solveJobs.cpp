@@ -0,0 +1,148 @@
+#include "solveJobs.h"
+#include <cstring>
+
+SolveJobs::SolveJobs(Runner runner, int workers, size_t maxUnfinished, size_t maxFinished)
+    : runner(runner), maxUnfinished(maxUnfinished), maxFinished(maxFinished), unfinished(0), nextId(1),
+      pool(new ThreadPool(workers)) {
+}
+
+SolveJobs::~SolveJobs() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : jobs) {
+            entry.second->cancelled = true;
+        }
+    }
+    pool.reset();
+}
+
+const char* SolveJobs::stateName(State state) {
+    switch (state) {
+        case QUEUED: return "queued";
+        case RUNNING: return "running";
+        case SOLVED: return "solved";
+        case UNSOLVABLE: return "unsolvable";
+        case CANCELLED: return "cancelled";
+        case TIMED_OUT: return "timeout";
+    }
+    return "unknown";
+}
+
+void SolveJobs::setListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->listener = listener;
+}
+
+long long SolveJobs::submit(const int grid[81], std::chrono::milliseconds timeout, const std::string& owner) {
+    std::shared_ptr<Job> job(new Job());
+    std::memcpy(job->status.grid, grid, sizeof(job->status.grid));
+    job->status.owner = owner;
+    job->status.state = QUEUED;
+    job->status.elapsedMs = 0;
+    job->cancelled = false;
+    job->limits.cancel = &job->cancelled;
+    if (timeout.count() > 0) {
+        // Time spent waiting in the queue counts against the deadline
+        job->limits.deadline = SearchLimits::Clock::now() + timeout;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (unfinished >= maxUnfinished) {
+            return -1;
+        }
+        job->status.id = nextId++;
+        jobs[job->status.id] = job;
+        unfinished++;
+    }
+
+    pool->submit([this, job](int) {
+        run(job);
+    });
+    return job->status.id;
+}
+
+bool SolveJobs::cancel(long long id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return false;
+    }
+    State state = it->second->status.state;
+    if (state != QUEUED && state != RUNNING) {
+        return false;
+    }
+    // A queued job is dropped when a worker picks it up, a running one
+    // stops at the solver's next poll
+    it->second->cancelled = true;
+    return true;
+}
+
+bool SolveJobs::getStatus(long long id, Status& status) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return false;
+    }
+    status = it->second->status;
+    return true;
+}
+
+void SolveJobs::run(const std::shared_ptr<Job>& job) {
+    if (job->cancelled) {
+        finish(job, CANCELLED, 0);
+        return;
+    }
+    if (job->limits.expired()) {
+        finish(job, TIMED_OUT, 0);
+        return;
+    }
+
+    // The solver works on its own copy; the shared status is only written
+    // under the lock
+    int grid[81];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->status.state = RUNNING;
+        std::memcpy(grid, job->status.grid, sizeof(grid));
+    }
+
+    SearchLimits::Clock::time_point start = SearchLimits::Clock::now();
+    bool solved = runner(grid, job->limits);
+    long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(SearchLimits::Clock::now() - start).count();
+
+    if (solved) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::memcpy(job->status.grid, grid, sizeof(grid));
+    }
+    // A search stopped by the limits reports failure like an unsolvable
+    // puzzle; the limits tell which one it was
+    State state = solved ? SOLVED
+                : job->cancelled ? CANCELLED
+                : job->limits.expired() ? TIMED_OUT
+                : UNSOLVABLE;
+    finish(job, state, elapsedMs);
+}
+
+void SolveJobs::finish(const std::shared_ptr<Job>& job, State state, long long elapsedMs) {
+    Status status;
+    Listener notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->status.state = state;
+        job->status.elapsedMs = elapsedMs;
+        status = job->status;
+        notify = listener;
+
+        unfinished--;
+        finished.push_back(status.id);
+        while (finished.size() > maxFinished) {
+            jobs.erase(finished.front());
+            finished.pop_front();
+        }
+    }
+
+    if (notify) {
+        notify(status);
+    }
+}
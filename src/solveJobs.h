@@ -0,0 +1,86 @@
+#ifndef SOLVEJOBS_H
+#define SOLVEJOBS_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "searchControl.h"
+#include "threadPool.h"
+
+// Asynchronous 9x9 solve jobs.
+//
+// submit() copies the puzzle into a new job and returns its id right away;
+// the job runs later on a small pool of its own, so slow puzzles never hold
+// up the caller (the HTTP event loop). Each job has a deadline and can be
+// cancelled; both reach the running solver through its SearchLimits. The
+// number of unfinished jobs is bounded, and only the most recent finished
+// jobs are kept for status queries.
+class SolveJobs {
+public:
+    enum State { QUEUED, RUNNING, SOLVED, UNSOLVABLE, CANCELLED, TIMED_OUT };
+
+    struct Status {
+        long long id;
+        State state;
+        int grid[81];           // The solution once SOLVED, the puzzle otherwise
+        long long elapsedMs;    // Time spent running (0 while queued)
+        std::string owner;      // Given to submit(), e.g. the GUI session
+    };
+
+    // Solves grid in place (81 values, row-major, 0 = empty); false if the
+    // puzzle has no solution or the limits stopped the search
+    typedef std::function<bool(int grid[81], const SearchLimits& limits)> Runner;
+
+    // Called on a job worker whenever a job finishes, in any final state
+    typedef std::function<void(const Status& status)> Listener;
+
+    SolveJobs(Runner runner, int workers = 1, size_t maxUnfinished = 64, size_t maxFinished = 256);
+    ~SolveJobs();           // Cancels every job and waits for the running ones
+
+    // Queue a job with the given time limit (0 = none). Returns its id, or
+    // -1 when maxUnfinished jobs are already queued or running.
+    long long submit(const int grid[81], std::chrono::milliseconds timeout, const std::string& owner = "");
+
+    // Cancel a queued or running job; false if it is unknown or finished
+    bool cancel(long long id);
+
+    // Current status of a job; false if the id is unknown (or evicted)
+    bool getStatus(long long id, Status& status) const;
+
+    void setListener(Listener listener);
+
+    static const char* stateName(State state);
+
+private:
+    struct Job {
+        Status status;
+        std::atomic<bool> cancelled;
+        SearchLimits limits;
+    };
+
+    Runner runner;
+    Listener listener;
+    size_t maxUnfinished;
+    size_t maxFinished;
+
+    mutable std::mutex mutex;
+    std::unordered_map<long long, std::shared_ptr<Job>> jobs;
+    std::deque<long long> finished;     // Oldest first, for eviction
+    size_t unfinished;
+    long long nextId;
+
+    // Declared last: destroyed first, while the jobs it runs still exist
+    std::unique_ptr<ThreadPool> pool;
+
+    SolveJobs(const SolveJobs&);
+    SolveJobs& operator=(const SolveJobs&);
+
+    void run(const std::shared_ptr<Job>& job);
+    void finish(const std::shared_ptr<Job>& job, State state, long long elapsedMs);
+};
+
+#endif
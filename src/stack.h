@@ -1,32 +1,61 @@
 #ifndef STACK_H
 #define STACK_H
 
-struct Move {
-    int row;
-    int col;
-    int value;
+#include <cstdint>
 
-    Move(int r = 0, int c = 0, int v = 0);
+// Compact move for the solver stacks: cell index (row * side + col, 10 bits,
+// enough for 25x25 boards) and digit (5 bits) packed into two bytes
+struct PackedMove {
+    std::uint16_t bits;
+
+    PackedMove() : bits(0) {}
+    PackedMove(int cell, int digit) : bits(static_cast<std::uint16_t>((cell << 5) | digit)) {}
+
+    int cell() const { return bits >> 5; }
+    int digit() const { return bits & 31; }
 };
 
-// Stack for backtracking Sudoku moves using dynamic array
-class Stack {
+// Stack with inline storage of a fixed capacity: no allocation, no resize.
+// Overflow and underflow are reported through the return value instead of
+// terminating the program.
+template <typename T, int Capacity>
+class FixedStack {
 private:
-    Move* data;
-    int topIndex;
-    int capacity;
-
-    void resize();
+    T data[Capacity];
+    int count;
 
 public:
-    Stack(int initialCapacity = 10);
-    ~Stack();
-
-    void push(const Move& move);
-    Move pop();
-    Move top() const;
-    bool isEmpty() const;
-    int size() const;
+    FixedStack() : count(0) {}
+
+    bool push(const T& item) {
+        if (count >= Capacity) {
+            return false;
+        }
+        data[count++] = item;
+        return true;
+    }
+
+    bool pop(T& item) {
+        if (count == 0) {
+            return false;
+        }
+        item = data[--count];
+        return true;
+    }
+
+    bool top(T& item) const {
+        if (count == 0) {
+            return false;
+        }
+        item = data[count - 1];
+        return true;
+    }
+
+    bool isEmpty() const { return count == 0; }
+    bool isFull() const { return count >= Capacity; }
+    int size() const { return count; }
+    int capacity() const { return Capacity; }
+    void clear() { count = 0; }
 };
 
 #endif // STACK_H
\ No newline at end of file
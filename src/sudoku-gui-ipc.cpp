@@ -1,17 +1,214 @@
 #include "sudoku-gui-ipc.h"
 #include <iostream>
-#include <sstream>
 #include <thread>
+#include <algorithm>
+#include <cerrno>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <cstring>
 #include <nlohmann/json.hpp>
+#include "gridCodec.h"
+#include "jsonWriter.h"
 
 using json = nlohmann::json;
 
-SudokuGuiIpc::SudokuGuiIpc(int port) 
-    : port_(port), isRunning_(false) {
+namespace {
+
+const size_t READ_CHUNK = 16 * 1024;
+const int MAX_EVENTS = 64;
+const std::chrono::seconds IDLE_TIMEOUT(60);
+const std::chrono::seconds HEARTBEAT_INTERVAL(15);
+const size_t MAX_PENDING_EVENTS = 1024 * 1024;
+
+// Messages kept per session while nobody picks them up; older ones are dropped
+const size_t MAX_QUEUED_MESSAGES = 256;
+
+// Time limit of a job that does not ask for one, and the most it may ask for
+const long long DEFAULT_JOB_TIMEOUT_MS = 30 * 1000;
+const long long MAX_JOB_TIMEOUT_MS = 10 * 60 * 1000;
+
+// Most puzzles one POST /api/batch may carry
+const size_t MAX_BATCH_PUZZLES = 10000;
+
+// Batches solved at once, and the most that may wait or run; more get 503
+const int BATCH_WORKERS = 2;
+const int MAX_PENDING_BATCHES = 8;
+
+// epoll keys of the two non-connection fds; connection ids start above them
+const unsigned long long LISTEN_KEY = 0;
+const unsigned long long WAKE_KEY = 1;
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Response with the CORS headers of the API. Every API response is built
+// here, so preflight answers and the responses themselves always agree.
+// A null content type leaves it out (204 answers); extraHeaders are whole
+// "Name: value\r\n" lines.
+std::string apiResponse(const char* status, const char* contentType, const std::string& body, const char* extraHeaders = "") {
+    std::string response = std::string("HTTP/1.1 ") + status + "\r\n";
+    if (contentType != nullptr) {
+        response += std::string("Content-Type: ") + contentType + "\r\n";
+    }
+    response += "Access-Control-Allow-Origin: *\r\n"
+                "Access-Control-Allow-Methods: GET, POST, DELETE, OPTIONS\r\n"
+                "Access-Control-Allow-Headers: Content-Type, X-Session-Id\r\n";
+    response += extraHeaders;
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
+std::string jsonResponse(const char* status, const std::string& body, const char* extraHeaders = "") {
+    return apiResponse(status, "application/json", body, extraHeaders);
+}
+
+// Response for a request the parser rejected
+std::string parseErrorResponse(HttpRequestParser::Status status) {
+    switch (status) {
+    case HttpRequestParser::HEADERS_TOO_LARGE:
+        return apiResponse("431 Request Header Fields Too Large", "text/plain", "Headers too large");
+    case HttpRequestParser::BODY_TOO_LARGE:
+        return apiResponse("413 Payload Too Large", "text/plain", "Request body too large");
+    case HttpRequestParser::NOT_IMPLEMENTED:
+        return apiResponse("501 Not Implemented", "text/plain", "Unsupported transfer encoding");
+    default:
+        return apiResponse("400 Bad Request", "text/plain", "Malformed request");
+    }
+}
+
+// Value of a query parameter of the request target, empty if it is missing
+std::string_view queryParam(const HttpRequest& request, std::string_view key) {
+    size_t query = request.target.find('?');
+    if (query == std::string_view::npos) {
+        return std::string_view();
+    }
+    std::string_view params = request.target.substr(query + 1);
+    while (!params.empty()) {
+        size_t amp = params.find('&');
+        std::string_view param = params.substr(0, amp);
+        if (param.size() > key.size() && param.substr(0, key.size()) == key && param[key.size()] == '=') {
+            return param.substr(key.size() + 1);
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        params.remove_prefix(amp + 1);
+    }
+    return std::string_view();
+}
+
+// Session of a request: the "session" query parameter, else the
+// X-Session-Id header, else "default". False if the name is not 1-64
+// characters of [A-Za-z0-9_-].
+bool sessionOf(const HttpRequest& request, std::string& session) {
+    std::string_view name = queryParam(request, "session");
+    if (name.empty()) {
+        name = request.header("X-Session-Id");
+    }
+    if (name.empty()) {
+        session = "default";
+        return true;
+    }
+    
+    if (name.size() > 64) {
+        return false;
+    }
+    for (char ch : name) {
+        bool valid = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_' || ch == '-';
+        if (!valid) {
+            return false;
+        }
+    }
+    session.assign(name.data(), name.size());
+    return true;
+}
+
+// {"error": message}
+std::string errorJson(std::string_view message) {
+    std::string body = "{\"error\":";
+    appendJsonString(body, message);
+    body += '}';
+    return body;
+}
+
+// Read a 9x9 grid of values 0-9 (0 = empty) from a JSON array of rows
+bool gridFromJson(const json& rows, int grid[81]) {
+    if (!rows.is_array() || rows.size() != 9) {
+        return false;
+    }
+    for (int row = 0; row < 9; row++) {
+        const json& values = rows[row];
+        if (!values.is_array() || values.size() != 9) {
+            return false;
+        }
+        for (int col = 0; col < 9; col++) {
+            if (!values[col].is_number_integer()) {
+                return false;
+            }
+            int value = values[col].get<int>();
+            if (value < 0 || value > 9) {
+                return false;
+            }
+            grid[row * 9 + col] = value;
+        }
+    }
+    return true;
+}
+
+// One puzzle of a batch as an 81-character line: a string is taken as it is
+// (the solver rejects malformed ones), a 9x9 grid is flattened. Anything
+// else becomes an empty line, which is reported as invalid.
+std::string batchLineFromJson(const json& puzzle) {
+    if (puzzle.is_string()) {
+        return puzzle.get<std::string>();
+    }
+    
+    int grid[81];
+    if (!gridFromJson(puzzle, grid)) {
+        return std::string();
+    }
+    std::string line(81, '0');
+    for (int cell = 0; cell < 81; cell++) {
+        line[cell] = static_cast<char>('0' + grid[cell]);
+    }
+    return line;
+}
+
+// True if the media type is listed in the request's Accept header
+bool accepts(const HttpRequest& request, std::string_view type) {
+    return request.header("Accept").find(type) != std::string_view::npos;
+}
+
+// Add the framing headers to a response built by handleRequest, so the
+// client can find its end on a connection that stays open
+std::string frameResponse(const std::string& response, bool keepAlive) {
+    size_t headerEnd = response.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        headerEnd = response.size();
+    }
+    size_t bodyStart = std::min(headerEnd + 4, response.size());
+    
+    std::string framed;
+    framed.reserve(response.size() + 64);
+    framed.append(response, 0, headerEnd);
+    framed += "\r\nContent-Length: " + std::to_string(response.size() - bodyStart);
+    framed += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    framed.append(response, bodyStart, std::string::npos);
+    return framed;
+}
+
+} // namespace
+
+SudokuGuiIpc::SudokuGuiIpc(int port, int backlog) 
+    : port_(port), backlog_(backlog), isRunning_(false), listenFd_(-1), epollFd_(-1), wakeFd_(-1), nextId_(WAKE_KEY + 1),
+      pendingBatches_(0), jobs_(nullptr), messageQueues_(MAX_SESSIONS) {
 }
 
 SudokuGuiIpc::~SudokuGuiIpc() {
@@ -23,9 +220,15 @@ bool SudokuGuiIpc::start() {
         return true;
     }
     
+    if (!openListener()) {
+        return false;
+    }
+    
     // Start the server thread
-    serverThread_ = std::thread(&SudokuGuiIpc::serverLoop, this);
+    worker_.reset(new ThreadPool(1));
+    batchWorkers_.reset(new ThreadPool(BATCH_WORKERS));
     isRunning_ = true;
+    serverThread_ = std::thread(&SudokuGuiIpc::serverLoop, this);
     
     std::cout << "HTTP server started on port " << port_ << std::endl;
     return true;
@@ -37,193 +240,630 @@ void SudokuGuiIpc::stop() {
     }
     
     isRunning_ = false;
+    wake();
     
     if (serverThread_.joinable()) {
         serverThread_.join();
     }
     
+    // Let running callbacks and batches finish before the wake-up fd goes away
+    worker_.reset();
+    batchWorkers_.reset();
+    
+    for (const auto& entry : connections_) {
+        if (entry.second.fd >= 0) {
+            close(entry.second.fd);
+        }
+    }
+    connections_.clear();
+    completions_.clear();
+    subscribers_.clear();
+    close(listenFd_);
+    close(epollFd_);
+    close(wakeFd_);
+    listenFd_ = epollFd_ = wakeFd_ = -1;
+    
     std::cout << "HTTP server stopped" << std::endl;
 }
 
-void SudokuGuiIpc::sendSudokuGrid(const Graph& sudokuGraph, bool isSolution) {
-    std::string jsonStr = sudokuGraphToJson(sudokuGraph, isSolution);
-    
-    // Add message to queue
-    std::lock_guard<std::mutex> lock(mutex_);
-    messageQueue_.push(jsonStr);
+void SudokuGuiIpc::sendSudokuGrid(const std::string& session, const Graph& sudokuGraph, bool isSolution) {
+    pushMessage(session, sudokuGraphToJson(sudokuGraph, isSolution));
     
     std::cout << "Sent Sudoku grid: " << (isSolution ? "solution" : "puzzle") << std::endl;
 }
 
-void SudokuGuiIpc::sendSolvingStatus(bool success, const std::string& message) {
-    json statusJson = {
-        {"type", "status"},
-        {"success", success},
-        {"message", message}
-    };
+// The messages are written field by field, keys in the order nlohmann::json
+// used to give them, so the frontend sees the same bytes as before
+void SudokuGuiIpc::sendSolvingStatus(const std::string& session, bool success, const std::string& message) {
+    std::string statusJson;
+    statusJson.reserve(64 + message.size());
+    statusJson += "{\"message\":";
+    appendJsonString(statusJson, message);
+    statusJson += success ? ",\"success\":true,\"type\":\"status\"}" : ",\"success\":false,\"type\":\"status\"}";
     
-    // Add message to queue
-    std::lock_guard<std::mutex> lock(mutex_);
-    messageQueue_.push(statusJson.dump());
+    pushMessage(session, std::move(statusJson));
     
     std::cout << "Sent solving status: " << (success ? "success" : "failure") 
               << " - " << message << std::endl;
 }
 
-void SudokuGuiIpc::sendError(const std::string& errorMessage) {
-    json errorJson = {
-        {"type", "error"},
-        {"message", errorMessage}
-    };
+void SudokuGuiIpc::sendError(const std::string& session, const std::string& errorMessage) {
+    std::string errorJson;
+    errorJson.reserve(48 + errorMessage.size());
+    errorJson += "{\"message\":";
+    appendJsonString(errorJson, errorMessage);
+    errorJson += ",\"type\":\"error\"}";
     
-    // Add message to queue
-    std::lock_guard<std::mutex> lock(mutex_);
-    messageQueue_.push(errorJson.dump());
+    pushMessage(session, std::move(errorJson));
     
     std::cout << "Sent error: " << errorMessage << std::endl;
 }
 
-void SudokuGuiIpc::setOnPuzzleReceived(std::function<void(const std::vector<std::vector<int>>& puzzle)> callback) {
+void SudokuGuiIpc::sendSolutionCount(const std::string& session, int count, int limit, bool stopped) {
+    bool complete = !stopped && count < limit;
+    std::string countJson;
+    countJson.reserve(96);
+    countJson += complete ? "{\"complete\":true,\"count\":" : "{\"complete\":false,\"count\":";
+    appendJsonNumber(countJson, count);
+    countJson += ",\"limit\":";
+    appendJsonNumber(countJson, limit);
+    countJson += complete && count == 1 && limit > 1 ? ",\"type\":\"count\",\"unique\":true}" : ",\"type\":\"count\",\"unique\":false}";
+    
+    pushMessage(session, std::move(countJson));
+    
+    std::cout << "Sent solution count: " << count << (complete ? "" : "+") << (stopped ? " (time limit)" : "") << std::endl;
+}
+
+// Queue a message for a session and wake the event loop to push it to the
+// session's subscribers
+void SudokuGuiIpc::pushMessage(const std::string& session, std::string message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::queue<std::string>& queue = messageQueues_.touch(session);
+        if (queue.size() == MAX_QUEUED_MESSAGES) {
+            queue.pop();
+        }
+        queue.push(std::move(message));
+        updatedSessions_.push_back(session);
+    }
+    if (isRunning_) {
+        wake();
+    }
+}
+
+void SudokuGuiIpc::setOnPuzzleReceived(std::function<void(const std::string& session, const std::vector<std::vector<int>>& puzzle)> callback) {
     onPuzzleReceived_ = callback;
 }
 
-void SudokuGuiIpc::setOnSolveRequested(std::function<void()> callback) {
+void SudokuGuiIpc::sendJobStatus(const SolveJobs::Status& status) {
+    pushMessage(status.owner, jobStatusToJson(status, true));
+}
+
+void SudokuGuiIpc::setJobs(SolveJobs* jobs) {
+    jobs_ = jobs;
+}
+
+void SudokuGuiIpc::setOnSolveRequested(std::function<long long(const std::string& session)> callback) {
     onSolveRequested_ = callback;
 }
 
-void SudokuGuiIpc::setOnFileUploaded(std::function<void(const std::string& filename, const std::string& content)> callback) {
+void SudokuGuiIpc::setOnCountRequested(std::function<void(const std::string& session, int limit)> callback) {
+    onCountRequested_ = callback;
+}
+
+void SudokuGuiIpc::setOnBatchRequested(std::function<void(const std::vector<std::string>& lines, std::chrono::milliseconds timeout, std::string& output)> callback) {
+    onBatchRequested_ = callback;
+}
+
+void SudokuGuiIpc::setOnFileUploaded(std::function<void(const std::string& session, const std::string& filename, const std::string& content)> callback) {
     onFileUploaded_ = callback;
 }
 
-void SudokuGuiIpc::serverLoop() {
+// Create the non-blocking listening socket, the epoll set and the wake-up fd
+bool SudokuGuiIpc::openListener() {
     // Create socket
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
         std::cerr << "Error creating socket" << std::endl;
-        return;
+        return false;
     }
     
     // Set socket options
     int opt = 1;
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         std::cerr << "Error setting socket options" << std::endl;
-        close(serverSocket);
-        return;
+        close(listenFd_);
+        return false;
     }
     
     // Bind socket
     struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(port_);
     
-    if (bind(serverSocket, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        std::cerr << "Error binding socket" << std::endl;
-        close(serverSocket);
-        return;
+    if (bind(listenFd_, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        std::cerr << "Error binding socket to port " << port_ << ": " << std::strerror(errno) << std::endl;
+        close(listenFd_);
+        return false;
     }
     
     // Listen for connections
-    if (listen(serverSocket, 3) < 0) {
+    if (listen(listenFd_, backlog_) < 0 || !setNonBlocking(listenFd_)) {
         std::cerr << "Error listening on socket" << std::endl;
-        close(serverSocket);
-        return;
+        close(listenFd_);
+        return false;
+    }
+    
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = LISTEN_KEY;
+    bool registered = epollFd_ >= 0 && wakeFd_ >= 0 && epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event) == 0;
+    event.data.u64 = WAKE_KEY;
+    registered = registered && epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event) == 0;
+    
+    if (!registered) {
+        std::cerr << "Error setting up epoll" << std::endl;
+        close(listenFd_);
+        if (epollFd_ >= 0) close(epollFd_);
+        if (wakeFd_ >= 0) close(wakeFd_);
+        listenFd_ = epollFd_ = wakeFd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void SudokuGuiIpc::wake() {
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) < 0) {
+        // The counter is already non-zero, so the loop will wake anyway
     }
+}
+
+void SudokuGuiIpc::serverLoop() {
+    struct epoll_event events[MAX_EVENTS];
+    std::chrono::steady_clock::time_point lastSweep = std::chrono::steady_clock::now();
     
-    // Accept connections and handle requests
     while (isRunning_) {
-        // Set up select to allow for non-blocking accept
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(serverSocket, &readfds);
+        // Wake up at least once a second to drop idle connections
+        int ready = epoll_wait(epollFd_, events, MAX_EVENTS, 1000);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                std::cerr << "Error in epoll_wait" << std::endl;
+            }
+            continue;
+        }
         
-        struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
+        for (int i = 0; i < ready; i++) {
+            unsigned long long key = events[i].data.u64;
+            
+            if (key == LISTEN_KEY) {
+                acceptConnections();
+                continue;
+            }
+            
+            if (key == WAKE_KEY) {
+                uint64_t count;
+                if (read(wakeFd_, &count, sizeof(count)) < 0) {
+                    // Nothing pending; spurious wake-up
+                }
+                finishCompletions();
+                publishMessages();
+                continue;
+            }
+            
+            auto it = connections_.find(key);
+            if (it == connections_.end() || it->second.fd < 0) {
+                continue;
+            }
+            
+            Connection& connection = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(connection);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readFromConnection(connection);
+            } else if (events[i].events & EPOLLOUT) {
+                writeToConnection(connection);
+            }
+        }
         
-        int activity = select(serverSocket + 1, &readfds, NULL, NULL, &timeout);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+            closeIdleConnections();
+            lastSweep = now;
+        }
+    }
+}
+
+void SudokuGuiIpc::acceptConnections() {
+    // Drain the accept queue; the listening socket is non-blocking
+    while (true) {
+        int clientSocket = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSocket < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Error accepting connection: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
         
-        if (activity < 0) {
-            if (errno != EINTR) {
-                std::cerr << "Error in select" << std::endl;
+        unsigned long long id = nextId_++;
+        Connection& connection = connections_[id];
+        connection.id = id;
+        connection.fd = clientSocket;
+        connection.outputSent = 0;
+        connection.continueSent = false;
+        connection.busy = false;
+        connection.closeAfterWrite = false;
+        connection.streaming = false;
+        connection.lastActivity = std::chrono::steady_clock::now();
+        
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientSocket, &event) < 0) {
+            closeConnection(connection);
+        }
+    }
+}
+
+// Read and parse until the socket is drained. Each read is parsed right
+// away, so an oversized request is refused before it is buffered, and
+// reading pauses while the worker holds views into the buffer.
+void SudokuGuiIpc::readFromConnection(Connection& connection) {
+    char buffer[READ_CHUNK];
+    
+    while (!connection.busy && !connection.closeAfterWrite) {
+        ssize_t count = read(connection.fd, buffer, sizeof(buffer));
+        if (count > 0) {
+            if (connection.streaming) {
+                continue; // A subscriber has nothing more to say; only EOF matters
             }
+            connection.input.append(buffer, static_cast<size_t>(count));
+            connection.lastActivity = std::chrono::steady_clock::now();
+            processRequests(connection);
             continue;
         }
-        
-        if (activity == 0) {
-            // Timeout, check if we should continue running
+        if (count == 0) {
+            // Peer closed; answer what is already complete, then close
+            connection.closeAfterWrite = true;
+            break;
+        }
+        if (errno == EINTR) {
             continue;
         }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(connection);
+            return;
+        }
+        break;
+    }
+    
+    writeToConnection(connection);
+}
+
+// Answer the complete requests at the front of the input buffer, one at a
+// time: a request sent to the worker holds back the ones behind it, so
+// responses keep the order of the requests
+void SudokuGuiIpc::processRequests(Connection& connection) {
+    while (!connection.busy && !connection.input.empty()) {
+        HttpRequestParser::Status status = connection.parser.parse(connection.input);
+        
+        if (status == HttpRequestParser::INCOMPLETE) {
+            if (connection.parser.expectsContinue() && !connection.continueSent) {
+                connection.output += "HTTP/1.1 100 Continue\r\n\r\n";
+                connection.continueSent = true;
+            }
+            break;
+        }
+        if (status != HttpRequestParser::COMPLETE) {
+            connection.output += frameResponse(parseErrorResponse(status), false);
+            connection.input.clear();
+            connection.parser.reset();
+            connection.closeAfterWrite = true;
+            break;
+        }
         
-        // Accept connection
-        int clientSocket;
-        struct sockaddr_in clientAddress;
-        int addrlen = sizeof(clientAddress);
+        // Requests with a body to parse go to the worker (the callbacks and
+        // job submissions) or the batch workers; the rest only read server
+        // state and are answered right here.
+        const HttpRequest& request = connection.parser.request();
+        if (request.method == "GET" && request.target.substr(0, request.target.find('?')) == "/api/events") {
+            std::string session;
+            if (!sessionOf(request, session)) {
+                finishRequest(connection, jsonResponse("400 Bad Request", "{\"error\":\"Invalid session\"}"));
+                continue;
+            }
+            subscribe(connection, session);
+            break;
+        }
+        std::string_view path = request.target.substr(0, request.target.find('?'));
+        if (request.method == "POST" && (path == "/api/puzzle" || path == "/api/jobs")) {
+            runOnWorker(*worker_, connection, false);
+            break;
+        }
+        if (request.method == "POST" && path == "/api/batch") {
+            if (pendingBatches_ >= MAX_PENDING_BATCHES) {
+                finishRequest(connection, jsonResponse("503 Service Unavailable",
+                                                       "{\"error\":\"Too many batches in progress\"}",
+                                                       "Retry-After: 1\r\n"));
+                continue;
+            }
+            pendingBatches_++;
+            runOnWorker(*batchWorkers_, connection, true);
+            break;
+        }
         
-        if ((clientSocket = accept(serverSocket, (struct sockaddr *)&clientAddress, (socklen_t*)&addrlen)) < 0) {
-            std::cerr << "Error accepting connection" << std::endl;
+        finishRequest(connection, handleRequest(request));
+    }
+}
+
+// Handle the request at the front of the buffer on a worker pool and answer
+// it through the completion queue. The worker reads the request in place,
+// so the connection takes no further requests until then.
+void SudokuGuiIpc::runOnWorker(ThreadPool& pool, Connection& connection, bool batch) {
+    connection.busy = true;
+    unsigned long long id = connection.id;
+    const HttpRequest& request = connection.parser.request();
+    pool.submit([this, id, &request, batch](int) {
+        std::string response = handleRequest(request);
+        {
+            std::lock_guard<std::mutex> lock(completionMutex_);
+            completions_.push_back(Completion{id, response, batch});
+        }
+        wake();
+    });
+}
+
+// Queue the response of the request at the front of the buffer and drop it
+void SudokuGuiIpc::finishRequest(Connection& connection, const std::string& response) {
+    bool keepAlive = connection.parser.request().keepAlive;
+    connection.output += frameResponse(response, keepAlive);
+    
+    connection.input.erase(0, connection.parser.consumed());
+    connection.parser.reset();
+    connection.continueSent = false;
+    connection.busy = false;
+    if (!keepAlive) {
+        connection.input.clear();
+        connection.closeAfterWrite = true;
+    }
+}
+
+void SudokuGuiIpc::writeToConnection(Connection& connection) {
+    while (connection.outputSent < connection.output.size()) {
+        ssize_t count = send(connection.fd, connection.output.data() + connection.outputSent,
+                             connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+        if (count > 0) {
+            connection.outputSent += static_cast<size_t>(count);
+            connection.lastActivity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(connection); // Wait for EPOLLOUT
+            return;
+        }
+        closeConnection(connection);
+        return;
+    }
+    
+    connection.output.clear();
+    connection.outputSent = 0;
+    if (connection.closeAfterWrite && !connection.busy) {
+        closeConnection(connection);
+        return;
+    }
+    updateInterest(connection);
+}
+
+// Read while no request is on the worker, write while output is pending
+void SudokuGuiIpc::updateInterest(Connection& connection) {
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = 0;
+    if (!connection.busy && !connection.closeAfterWrite) {
+        event.events |= EPOLLIN;
+    }
+    if (connection.outputSent < connection.output.size()) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.u64 = connection.id;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+// Close the socket. A connection whose request is still on the worker keeps
+// its buffers until the worker is done with them.
+void SudokuGuiIpc::closeConnection(Connection& connection) {
+    if (connection.streaming) {
+        connection.streaming = false;
+        auto it = subscribers_.find(connection.session);
+        std::vector<unsigned long long>& streams = it->second;
+        streams.erase(std::find(streams.begin(), streams.end(), connection.id));
+        if (streams.empty()) {
+            subscribers_.erase(it);
+        }
+    }
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+    close(connection.fd);
+    connection.fd = -1;
+    if (!connection.busy) {
+        connections_.erase(connection.id);
+    }
+}
+
+// Queue the responses of finished worker requests on their connections
+void SudokuGuiIpc::finishCompletions() {
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        finished.swap(completions_);
+    }
+    
+    for (const Completion& completion : finished) {
+        if (completion.batch) {
+            pendingBatches_--;
+        }
+        auto it = connections_.find(completion.id);
+        if (it == connections_.end()) {
             continue;
         }
         
-        // Read request
-        char buffer[4096] = {0};
-        int valread = read(clientSocket, buffer, 4096);
-        if (valread < 0) {
-            std::cerr << "Error reading from socket" << std::endl;
-            close(clientSocket);
+        Connection& connection = it->second;
+        if (connection.fd < 0) {
+            connections_.erase(it); // The client went away meanwhile
             continue;
         }
         
-        // Handle request
-        std::string response = handleRequest(buffer);
+        finishRequest(connection, completion.response);
+        processRequests(connection);
+        writeToConnection(connection);
+    }
+}
+
+// Turn the connection into a server-sent event stream (GET /api/events).
+// The response never ends: every queued message is written to it as one
+// event, so the frontend no longer has to poll /api/messages.
+void SudokuGuiIpc::subscribe(Connection& connection, const std::string& session) {
+    connection.output += apiResponse("200 OK", "text/event-stream", "retry: 1000\n\n",
+                                     "Cache-Control: no-cache\r\n"
+                                     "Connection: keep-alive\r\n");
+    connection.input.clear();
+    connection.parser.reset();
+    connection.streaming = true;
+    connection.session = session;
+    subscribers_[session].push_back(connection.id);
+    
+    // Hand over what queued up while nobody was listening
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        updatedSessions_.push_back(session);
+    }
+    publishMessages();
+}
+
+// Write the queued messages of each session to its subscribers. Sessions
+// without subscribers keep them for GET /api/messages.
+void SudokuGuiIpc::publishMessages() {
+    std::vector<std::string> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions.swap(updatedSessions_);
+    }
+    
+    for (const std::string& session : sessions) {
+        auto subscribed = subscribers_.find(session);
+        if (subscribed == subscribers_.end()) {
+            continue;
+        }
         
-        // Send response
-        send(clientSocket, response.c_str(), response.length(), 0);
+        // The messages are single-line JSON, so each fits one data: field
+        events_.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::queue<std::string>* queue = messageQueues_.find(session);
+            while (queue != nullptr && !queue->empty()) {
+                events_ += "data: ";
+                events_ += queue->front();
+                events_ += "\n\n";
+                queue->pop();
+            }
+        }
+        if (events_.empty()) {
+            continue;
+        }
         
-        // Close connection
-        close(clientSocket);
+        // Closing a stream edits the list, so walk a copy
+        std::vector<unsigned long long> streams = subscribed->second;
+        for (unsigned long long id : streams) {
+            Connection& connection = connections_.at(id);
+            // A subscriber that stopped reading is dropped, not buffered forever
+            if (connection.output.size() - connection.outputSent > MAX_PENDING_EVENTS) {
+                closeConnection(connection);
+                continue;
+            }
+            connection.output += events_;
+            writeToConnection(connection);
+        }
     }
-    
-    // Close server socket
-    close(serverSocket);
 }
 
-std::string SudokuGuiIpc::handleRequest(const std::string& request) {
-    // Parse HTTP request
-    std::istringstream requestStream(request);
-    std::string method, path, httpVersion;
-    requestStream >> method >> path >> httpVersion;
+// Drop idle connections. Event streams are idle by nature; they get a
+// comment line instead, which keeps proxies from timing them out and
+// notices peers that went away.
+void SudokuGuiIpc::closeIdleConnections() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::vector<Connection*> idle;
+    std::vector<Connection*> quiet;
+    for (auto& entry : connections_) {
+        Connection& connection = entry.second;
+        if (connection.streaming) {
+            if (connection.output.empty() && now - connection.lastActivity > HEARTBEAT_INTERVAL) {
+                quiet.push_back(&connection);
+            }
+        } else if (connection.fd >= 0 && !connection.busy && connection.output.empty() && now - connection.lastActivity > IDLE_TIMEOUT) {
+            idle.push_back(&connection);
+        }
+    }
+    for (Connection* connection : idle) {
+        closeConnection(*connection);
+    }
+    for (Connection* connection : quiet) {
+        connection->output += ":\n\n";
+        writeToConnection(*connection);
+    }
+}
+
+std::string SudokuGuiIpc::handleRequest(const HttpRequest& request) {
+    // The parser already split the request; ignore any query string
+    std::string_view method = request.method;
+    std::string_view path = request.target.substr(0, request.target.find('?'));
+    
+    std::string session;
+    if (!sessionOf(request, session)) {
+        return jsonResponse("400 Bad Request", "{\"error\":\"Invalid session\"}");
+    }
     
     // Handle different endpoints
     if (path == "/api/puzzle") {
         // Handle POST requests to /api/puzzle
         if (method == "POST") {
-            // Find the start of the JSON body
-            size_t bodyStart = request.find("\r\n\r\n");
-            if (bodyStart != std::string::npos) {
-                std::string body = request.substr(bodyStart + 4);
-                
+            if (!request.body.empty()) {
                 // Debug output to see what's being received
-                std::cout << "Received body: " << body << std::endl;
+                std::cout << "Received body: " << request.body.size() << " bytes" << std::endl;
                 
                 try {
-                    // Parse JSON body
-                    json requestJson = json::parse(body);
+                    // Parse JSON body straight from the receive buffer
+                    json requestJson = json::parse(request.body.begin(), request.body.end());
                     
                     // Check request type
                     if (requestJson.contains("type")) {
                         std::string type = requestJson["type"];
                         
                         if (type == "solve" && onSolveRequested_) {
-                            // Handle solve request
-                            onSolveRequested_();
-                            return "HTTP/1.1 200 OK\r\n"
-                                   "Content-Type: application/json\r\n"
-                                   "Access-Control-Allow-Origin: *\r\n"
-                                   "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                                   "Access-Control-Allow-Headers: Content-Type\r\n"
-                                   "\r\n"
-                                   "{\"status\":\"solving\"}";
+                            // Handle solve request; the solve itself runs as a job
+                            long long id = onSolveRequested_(session);
+                            return jsonResponse("200 OK", "{\"status\":\"solving\",\"job\":" + std::to_string(id) + "}");
+                        }
+                        else if (type == "count" && onCountRequested_) {
+                            // Handle solution count request (default: uniqueness check)
+                            long long limit = requestJson.value("limit", 2LL);
+                            if (limit > MAX_COUNT_LIMIT) {
+                                return jsonResponse("400 Bad Request", "{\"error\":\"limit must be at most " + std::to_string(MAX_COUNT_LIMIT) + "\"}");
+                            }
+                            if (limit >= 1) {
+                                onCountRequested_(session, static_cast<int>(limit));
+                                return jsonResponse("200 OK", "{\"status\":\"counting\"}");
+                            }
                         }
                         else if (type == "file" && onFileUploaded_) {
                             // Handle file upload
@@ -235,65 +875,56 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
                                 content.erase(0, content.find_first_not_of(" \n\r\t"));
                                 content.erase(content.find_last_not_of(" \n\r\t") + 1);
                                 
-                                onFileUploaded_(filename, content);
+                                onFileUploaded_(session, filename, content);
                                 
-                                return "HTTP/1.1 200 OK\r\n"
-                                       "Content-Type: application/json\r\n"
-                                       "Access-Control-Allow-Origin: *\r\n"
-                                       "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                                       "Access-Control-Allow-Headers: Content-Type\r\n"
-                                       "\r\n"
-                                       "{\"status\":\"file_uploaded\"}";
+                                return jsonResponse("200 OK", "{\"status\":\"file_uploaded\"}");
                             }
                         }
                     }
                 }
                 catch (const json::exception& e) {
                     // Return detailed error for debugging
-                    std::string errorMsg = "{\"error\":\"" + std::string(e.what()) + "\"}";
-                    return "HTTP/1.1 400 Bad Request\r\n"
-                           "Content-Type: application/json\r\n"
-                           "Access-Control-Allow-Origin: *\r\n"
-                           "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                           "Access-Control-Allow-Headers: Content-Type\r\n"
-                           "\r\n" + errorMsg;
+                    return jsonResponse("400 Bad Request", errorJson(e.what()));
                 }
             }
             
             // If we get here, the request was invalid
-            return "HTTP/1.1 400 Bad Request\r\n"
-                   "Content-Type: application/json\r\n"
-                   "Access-Control-Allow-Origin: *\r\n"
-                   "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                   "Access-Control-Allow-Headers: Content-Type\r\n"
-                   "\r\n"
-                   "{\"error\":\"Invalid request\"}";
+            return jsonResponse("400 Bad Request", "{\"error\":\"Invalid request\"}");
         }
         // Handle OPTIONS requests (CORS preflight)
         else if (method == "OPTIONS") {
-            return "HTTP/1.1 204 No Content\r\n"
-                   "Access-Control-Allow-Origin: *\r\n"
-                   "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                   "Access-Control-Allow-Headers: Content-Type\r\n"
-                   "\r\n";
+            return apiResponse("204 No Content", nullptr, "");
         }
     } 
+    else if (path == "/api/batch") {
+        return handleBatchRequest(request);
+    }
+    else if (path == "/api/jobs" || path.substr(0, 10) == "/api/jobs/") {
+        return handleJobRequest(request, path, session);
+    }
     else if (path == "/api/messages" && method == "GET") {
-        // Return any pending messages
+        // Return any pending messages of the session
         std::lock_guard<std::mutex> lock(mutex_);
+        std::queue<std::string>* queue = messageQueues_.find(session);
         
-        if (messageQueue_.empty()) {
-            return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n[]";
+        if (queue == nullptr || queue->empty()) {
+            return jsonResponse("200 OK", "[]");
         }
         
-        json messages = json::array();
-        
-        while (!messageQueue_.empty()) {
-            messages.push_back(json::parse(messageQueue_.front()));
-            messageQueue_.pop();
+        // The queue holds serialized JSON already; join it into an array
+        std::string response = jsonResponse("200 OK", "[");
+        bool first = true;
+        while (!queue->empty()) {
+            if (!first) {
+                response += ',';
+            }
+            response += queue->front();
+            queue->pop();
+            first = false;
         }
+        response += ']';
         
-        return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + messages.dump();
+        return response;
     } 
     else if (path == "/" && method == "GET") {
         // Serve a simple HTML page for testing
@@ -351,29 +982,13 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
             });
             
             document.getElementById('status').textContent = 'Solving...';
-            
-            // Poll for messages
-            pollMessages();
         });
         
-        // Poll for messages
-        function pollMessages() {
-            fetch('/api/messages')
-                .then(response => response.json())
-                .then(messages => {
-                    if (messages.length > 0) {
-                        for (const message of messages) {
-                            handleMessage(message);
-                        }
-                    }
-                    
-                    // Continue polling
-                    setTimeout(pollMessages, 1000);
-                })
-                .catch(error => {
-                    console.error('Error polling messages:', error);
-                    setTimeout(pollMessages, 5000);
-                });
+        // Listen for messages pushed by the server
+        function listenForMessages() {
+            const events = new EventSource('/api/events');
+            events.onmessage = event => handleMessage(JSON.parse(event.data));
+            events.onerror = () => console.error('Event stream interrupted, reconnecting');
         }
         
         // Handle incoming messages
@@ -399,8 +1014,8 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
             }
         }
         
-        // Start polling for messages
-        pollMessages();
+        // Start listening for messages
+        listenForMessages();
     </script>
 </body>
 </html>
@@ -421,10 +1036,7 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
 0 0 0 0 8 0 0 7 9
         )";
         
-        return "HTTP/1.1 200 OK\r\n"
-               "Content-Type: text/plain\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "\r\n" + content;
+        return apiResponse("200 OK", "text/plain", content);
     }
     else if (path == "/sample_sudoku_M.txt") {
         std::string content = R"(
@@ -439,10 +1051,7 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
 7 0 3 0 1 8 0 0 0
         )";
         
-        return "HTTP/1.1 200 OK\r\n"
-               "Content-Type: text/plain\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "\r\n" + content;
+        return apiResponse("200 OK", "text/plain", content);
     }
     else if (path == "/sample_sudoku_H.txt") {
         std::string content = R"(
@@ -457,32 +1066,294 @@ std::string SudokuGuiIpc::handleRequest(const std::string& request) {
 0 0 0 0 0 0 0 4 0
         )";
         
-        return "HTTP/1.1 200 OK\r\n"
-               "Content-Type: text/plain\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "\r\n" + content;
+        return apiResponse("200 OK", "text/plain", content);
     }
     
     // Default response for unknown paths
-    return "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n\r\nNot Found";
+    return apiResponse("404 Not Found", "text/plain", "Not Found");
 }
 
-std::string SudokuGuiIpc::sudokuGraphToJson(const Graph& sudokuGraph, bool isSolution) {
-    json gridJson = json::array();
+// /api/jobs endpoints. They only touch the job table, so they are answered
+// on the event loop like the other non-callback requests.
+std::string SudokuGuiIpc::handleJobRequest(const HttpRequest& request, std::string_view path, const std::string& session) {
+    std::string_view method = request.method;
+    if (method == "OPTIONS") {
+        return apiResponse("204 No Content", nullptr, "");
+    }
+    if (jobs_ == nullptr) {
+        return jsonResponse("503 Service Unavailable", "{\"error\":\"Jobs are not available\"}");
+    }
     
-    for (int row = 0; row < 9; row++) {
-        json rowJson = json::array();
-        for (int col = 0; col < 9; col++) {
-            Node* cell = sudokuGraph.getNodeByPosition(row, col);
-            rowJson.push_back(cell->getValue());
+    // POST /api/jobs {"grid": [[...], ...], "timeoutMs": 5000}
+    if (path == "/api/jobs") {
+        if (method != "POST") {
+            return jsonResponse("405 Method Not Allowed", "{\"error\":\"Use POST to submit a job\"}");
+        }
+        
+        int grid[81];
+        long long timeoutMs = DEFAULT_JOB_TIMEOUT_MS;
+        try {
+            json requestJson = json::parse(request.body.begin(), request.body.end());
+            if (!requestJson.is_object() || !requestJson.contains("grid") || !gridFromJson(requestJson["grid"], grid)) {
+                return jsonResponse("400 Bad Request", "{\"error\":\"Expected a 9x9 grid of values 0-9\"}");
+            }
+            timeoutMs = requestJson.value("timeoutMs", DEFAULT_JOB_TIMEOUT_MS);
+        }
+        catch (const json::exception& e) {
+            return jsonResponse("400 Bad Request", errorJson(e.what()));
+        }
+        if (timeoutMs <= 0) {
+            return jsonResponse("400 Bad Request", "{\"error\":\"timeoutMs must be a positive number of milliseconds\"}");
+        }
+        if (timeoutMs > MAX_JOB_TIMEOUT_MS) {
+            timeoutMs = MAX_JOB_TIMEOUT_MS;
+        }
+        
+        long long id = jobs_->submit(grid, std::chrono::milliseconds(timeoutMs), session);
+        if (id < 0) {
+            return jsonResponse("503 Service Unavailable", "{\"error\":\"Too many unfinished jobs\"}", "Retry-After: 1\r\n");
+        }
+        return jsonResponse("202 Accepted", "{\"id\":" + std::to_string(id) + ",\"status\":\"queued\"}");
+    }
+    
+    // GET or DELETE /api/jobs/<id>
+    std::string_view idText = path.substr(10);
+    long long id = 0;
+    if (idText.empty() || idText.size() > 18 || idText.find_first_not_of("0123456789") != std::string_view::npos) {
+        return jsonResponse("404 Not Found", "{\"error\":\"Unknown job\"}");
+    }
+    for (char ch : idText) {
+        id = id * 10 + (ch - '0');
+    }
+    
+    // Jobs of other sessions look the same as ids that were never used
+    SolveJobs::Status status;
+    if (!jobs_->getStatus(id, status) || status.owner != session) {
+        return jsonResponse("404 Not Found", "{\"error\":\"Unknown job\"}");
+    }
+    if (method == "GET") {
+        return jsonResponse("200 OK", jobStatusToJson(status, false));
+    }
+    if (method == "DELETE") {
+        if (!jobs_->cancel(id)) {
+            return jsonResponse("409 Conflict", jobStatusToJson(status, false));
+        }
+        return jsonResponse("202 Accepted", "{\"id\":" + std::to_string(id) + ",\"status\":\"cancelling\"}");
+    }
+    return jsonResponse("405 Method Not Allowed", "{\"error\":\"Use GET or DELETE on a job\"}");
+}
+
+// POST /api/batch. The body is either JSON, an array of puzzles or
+// {"puzzles": [...], "timeoutMs": N}, where a puzzle is an 81-character
+// string or a 9x9 grid; text/plain with one puzzle per line; or a binary
+// batch frame (see gridCodec.h). JSON requests get {"solutions": [...], ...}
+// with an 81-character string per solved puzzle and null otherwise (the
+// reason is listed in "errors"); text requests get one line per puzzle, as
+// in --batch mode; binary requests, and any request whose Accept names it,
+// get a binary result frame. Text and binary requests take the time limit
+// from the timeoutMs query parameter.
+std::string SudokuGuiIpc::handleBatchRequest(const HttpRequest& request) {
+    if (request.method == "OPTIONS") {
+        return apiResponse("204 No Content", nullptr, "");
+    }
+    if (request.method != "POST") {
+        return jsonResponse("405 Method Not Allowed", "{\"error\":\"Use POST to solve a batch\"}");
+    }
+    if (!onBatchRequested_) {
+        return jsonResponse("503 Service Unavailable", "{\"error\":\"Batches are not available\"}");
+    }
+    
+    std::vector<std::string> lines;
+    long long timeoutMs = DEFAULT_JOB_TIMEOUT_MS;
+    std::string_view contentType = request.header("Content-Type");
+    bool text = contentType.substr(0, 10) == "text/plain";
+    bool binary = contentType == BATCH_FRAME_TYPE;
+    bool binaryResults = accepts(request, RESULT_FRAME_TYPE) || (binary && !accepts(request, "application/json"));
+    
+    std::string_view timeoutParam = queryParam(request, "timeoutMs");
+    if (!timeoutParam.empty()) {
+        if (timeoutParam.size() > 18 || timeoutParam.find_first_not_of("0123456789") != std::string_view::npos) {
+            return jsonResponse("400 Bad Request", "{\"error\":\"timeoutMs must be a number of milliseconds\"}");
+        }
+        timeoutMs = std::stoll(std::string(timeoutParam));
+    }
+    
+    if (binary) {
+        size_t count = 0;
+        if (!readFrameHeader(request.body, PACKED_GRID_SIZE, count)) {
+            return jsonResponse("400 Bad Request", "{\"error\":\"Malformed batch frame\"}");
+        }
+        if (count > MAX_BATCH_PUZZLES) {
+            return jsonResponse("413 Payload Too Large", "{\"error\":\"At most " + std::to_string(MAX_BATCH_PUZZLES) + " puzzles per batch\"}");
+        }
+        
+        // A grid with a value above 9 becomes an empty line, reported as invalid
+        const unsigned char* packed = reinterpret_cast<const unsigned char*>(request.body.data()) + FRAME_HEADER_SIZE;
+        lines.resize(count);
+        for (size_t i = 0; i < count; i++, packed += PACKED_GRID_SIZE) {
+            lines[i].resize(81);
+            if (!unpackDigits(packed, &lines[i][0])) {
+                lines[i].clear();
+            }
+        }
+    } else if (text) {
+        // Blank lines and # comments are skipped, as in --batch mode
+        std::string_view body = request.body;
+        while (!body.empty()) {
+            size_t end = body.find('\n');
+            std::string_view line = body.substr(0, end);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!line.empty() && line[0] != '#') {
+                lines.emplace_back(line);
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            body.remove_prefix(end + 1);
+        }
+    } else {
+        try {
+            json requestJson = json::parse(request.body.begin(), request.body.end());
+            const json* puzzles = &requestJson;
+            if (requestJson.is_object()) {
+                if (!requestJson.contains("puzzles")) {
+                    return jsonResponse("400 Bad Request", "{\"error\":\"Expected an array of puzzles\"}");
+                }
+                puzzles = &requestJson["puzzles"];
+                timeoutMs = requestJson.value("timeoutMs", DEFAULT_JOB_TIMEOUT_MS);
+            }
+            if (!puzzles->is_array()) {
+                return jsonResponse("400 Bad Request", "{\"error\":\"Expected an array of puzzles\"}");
+            }
+            
+            lines.reserve(puzzles->size());
+            for (const json& puzzle : *puzzles) {
+                lines.push_back(batchLineFromJson(puzzle));
+            }
+        }
+        catch (const json::exception& e) {
+            return jsonResponse("400 Bad Request", errorJson(e.what()));
         }
-        gridJson.push_back(rowJson);
     }
     
-    json result = {
-        {"type", isSolution ? "solution" : "puzzle"},
-        {"grid", gridJson}
-    };
+    if (lines.size() > MAX_BATCH_PUZZLES) {
+        return jsonResponse("413 Payload Too Large", "{\"error\":\"At most " + std::to_string(MAX_BATCH_PUZZLES) + " puzzles per batch\"}");
+    }
+    if (timeoutMs <= 0) {
+        return jsonResponse("400 Bad Request", "{\"error\":\"timeoutMs must be a positive number of milliseconds\"}");
+    }
+    if (timeoutMs > MAX_JOB_TIMEOUT_MS) {
+        timeoutMs = MAX_JOB_TIMEOUT_MS;
+    }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string output;
+    output.reserve(lines.size() * 82);
+    onBatchRequested_(lines, std::chrono::milliseconds(timeoutMs), output);
+    long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Solved batch of " << lines.size() << " puzzles in " << elapsedMs << " ms" << std::endl;
     
-    return result.dump();
-} 
\ No newline at end of file
+    if (binaryResults) {
+        // The solutions are packed straight from the output lines
+        std::string frame;
+        frame.reserve(FRAME_HEADER_SIZE + lines.size() * (1 + PACKED_GRID_SIZE));
+        appendFrameHeader(frame, static_cast<uint32_t>(lines.size()));
+        std::string_view results = output;
+        for (size_t i = 0; i < lines.size(); i++) {
+            size_t end = results.find('\n');
+            std::string_view result = results.substr(0, end);
+            results.remove_prefix(end == std::string_view::npos ? results.size() : end + 1);
+            
+            unsigned char record[1 + PACKED_GRID_SIZE] = {};
+            if (result.size() == 81) {
+                record[0] = PACKED_SOLVED;
+                packDigits(result.data(), record + 1);
+            } else {
+                record[0] = result == "invalid" ? PACKED_INVALID
+                          : result == "timeout" ? PACKED_TIMED_OUT
+                          : PACKED_NO_SOLUTION;
+            }
+            frame.append(reinterpret_cast<const char*>(record), sizeof(record));
+        }
+        
+        return apiResponse("200 OK", RESULT_FRAME_TYPE, frame);
+    }
+    
+    if (text) {
+        return apiResponse("200 OK", "text/plain", output);
+    }
+    
+    // Solutions are digits and the reasons fixed words, so the response is
+    // written directly instead of through a json tree
+    std::string solutions;
+    std::string errors;
+    solutions.reserve(lines.size() * 84);
+    size_t solved = 0;
+    size_t index = 0;
+    std::string_view results = output;
+    while (!results.empty()) {
+        size_t end = results.find('\n');
+        std::string_view result = results.substr(0, end);
+        
+        if (index > 0) {
+            solutions += ',';
+        }
+        if (result.size() == 81) {
+            solutions += '"';
+            solutions.append(result.data(), result.size());
+            solutions += '"';
+            solved++;
+        } else {
+            solutions += "null";
+            if (!errors.empty()) {
+                errors += ',';
+            }
+            errors += "{\"index\":" + std::to_string(index) + ",\"reason\":\"";
+            errors.append(result.data(), result.size());
+            errors += "\"}";
+        }
+        index++;
+        
+        if (end == std::string_view::npos) {
+            break;
+        }
+        results.remove_prefix(end + 1);
+    }
+    
+    return jsonResponse("200 OK", "{\"solutions\":[" + solutions + "],\"solved\":" + std::to_string(solved)
+                        + ",\"total\":" + std::to_string(index) + ",\"elapsedMs\":" + std::to_string(elapsedMs)
+                        + ",\"errors\":[" + errors + "]}");
+}
+
+std::string SudokuGuiIpc::jobStatusToJson(const SolveJobs::Status& status, bool withType) {
+    std::string result;
+    result.reserve(status.state == SolveJobs::SOLVED ? 256 : 80);
+    result += "{\"elapsedMs\":";
+    appendJsonNumber(result, status.elapsedMs);
+    result += ",\"id\":";
+    appendJsonNumber(result, status.id);
+    if (status.state == SolveJobs::SOLVED) {
+        result += ",\"solution\":";
+        appendJsonGrid(result, status.grid);
+    }
+    result += ",\"status\":\"";
+    result += SolveJobs::stateName(status.state);
+    result += withType ? "\",\"type\":\"job\"}" : "\"}";
+    return result;
+}
+
+std::string SudokuGuiIpc::sudokuGraphToJson(const Graph& sudokuGraph, bool isSolution) {
+    int grid[81];
+    for (int cell = 0; cell < 81; cell++) {
+        grid[cell] = sudokuGraph.getValueAt(cell);
+    }
+    
+    std::string result;
+    result.reserve(256);
+    result += "{\"grid\":";
+    appendJsonGrid(result, grid);
+    result += isSolution ? ",\"type\":\"solution\"}" : ",\"type\":\"puzzle\"}";
+    return result;
+}
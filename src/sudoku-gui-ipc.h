@@ -8,66 +8,192 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include "graph.h"
+#include "threadPool.h"
+#include "httpRequestParser.h"
+#include "solveJobs.h"
+#include "lruCache.h"
 
+// HTTP server for the web frontend.
+//
+// One event-loop thread multiplexes the listening socket and every client
+// connection with epoll. Sockets are non-blocking: requests are parsed
+// incrementally as bytes arrive (httpRequestParser.h), responses are
+// flushed across partial writes, and connections stay open between
+// requests (HTTP keep-alive). Requests whose body has to be parsed (POST
+// /api/puzzle, /api/jobs and /api/batch) are handed to worker threads, so
+// the loop itself only does I/O and state lookups. Messages for the frontend are
+// pushed as server-sent events to clients of GET /api/events.
+//
+// Solves run as asynchronous jobs (solveJobs.h): POST /api/jobs queues one
+// and answers with its id, GET /api/jobs/<id> reports its state and
+// DELETE /api/jobs/<id> cancels it. POST /api/batch solves many puzzles in
+// one request and answers with all the solutions.
+//
+// Every request belongs to a session, named by a "session" query parameter
+// or an X-Session-Id header ("default" without either). Messages go to the
+// session they are sent to only, each session has its own queue, and a job
+// can only be read or cancelled from the session that submitted it; the
+// least recently used sessions are forgotten beyond MAX_SESSIONS.
 class SudokuGuiIpc {
 public:
-    SudokuGuiIpc(int port = 8080);
+    static const size_t MAX_SESSIONS = 1024;
+    
+    // Largest solution count limit a client may ask for
+    static const int MAX_COUNT_LIMIT = 1000;
+    
+    SudokuGuiIpc(int port = 8080, int backlog = 128);
     ~SudokuGuiIpc();
 
-    // Start the HTTP server
+    // Start the HTTP server; false if the port cannot be bound
     bool start();
     
     // Stop the HTTP server
     void stop();
     
-    // Send the current Sudoku grid to connected clients
-    void sendSudokuGrid(const Graph& sudokuGraph, bool isSolution = false);
+    // Send the current Sudoku grid to the clients of a session
+    void sendSudokuGrid(const std::string& session, const Graph& sudokuGraph, bool isSolution = false);
+    
+    // Send solving status to the clients of a session
+    void sendSolvingStatus(const std::string& session, bool success, const std::string& message = "");
+    
+    // Send error message to the clients of a session
+    void sendError(const std::string& session, const std::string& errorMessage);
     
-    // Send solving status to connected clients
-    void sendSolvingStatus(bool success, const std::string& message = "");
+    // Send the result of a solution count (count == limit means "at least",
+    // as does a count stopped by its time limit)
+    void sendSolutionCount(const std::string& session, int count, int limit, bool stopped = false);
     
-    // Send error message to connected clients
-    void sendError(const std::string& errorMessage);
+    // Send the state of a solve job (with its solution once solved) to the
+    // session that submitted it
+    void sendJobStatus(const SolveJobs::Status& status);
+    
+    // Jobs behind the /api/jobs endpoints; without them those answer 503
+    void setJobs(SolveJobs* jobs);
+    
+    // The callbacks receive the session of the request
     
     // Set callback for when a new Sudoku puzzle is received from the frontend
-    void setOnPuzzleReceived(std::function<void(const std::vector<std::vector<int>>& puzzle)> callback);
+    void setOnPuzzleReceived(std::function<void(const std::string& session, const std::vector<std::vector<int>>& puzzle)> callback);
     
-    // Set callback for when a solve request is received
-    void setOnSolveRequested(std::function<void()> callback);
+    // Set callback for when a solve request is received; it returns the id
+    // of the job it started, -1 if none
+    void setOnSolveRequested(std::function<long long(const std::string& session)> callback);
+    
+    // Set callback for when a solution count is requested (limit 2 = uniqueness check)
+    void setOnCountRequested(std::function<void(const std::string& session, int limit)> callback);
     
     // Set callback for when a file upload is received
-    void setOnFileUploaded(std::function<void(const std::string& filename, const std::string& content)> callback);
+    void setOnFileUploaded(std::function<void(const std::string& session, const std::string& filename, const std::string& content)> callback);
+    
+    // Set callback solving a batch: one puzzle per line in the --batch
+    // format, one output line per puzzle appended to output (the solution,
+    // "no solution", "invalid" or "timeout")
+    void setOnBatchRequested(std::function<void(const std::vector<std::string>& lines, std::chrono::milliseconds timeout, std::string& output)> callback);
 
 private:
-    // Port to listen on
+    // One client connection of the event loop
+    struct Connection {
+        unsigned long long id;          // epoll key; never reused, unlike the fd
+        int fd;                         // -1 once closed while the worker still reads its request
+        std::string input;              // Received bytes; the parser keeps offsets into them
+        HttpRequestParser parser;
+        bool continueSent;              // "100 Continue" already sent for this request
+        std::string output;             // Response bytes not written yet
+        size_t outputSent;
+        bool busy;                      // The request at the front of input is on the worker
+        bool closeAfterWrite;
+        bool streaming;                 // Subscribed to /api/events; only receives pushed messages
+        std::string session;            // Session of the event stream
+        std::chrono::steady_clock::time_point lastActivity;
+    };
+    
+    // Response produced by the worker, handed back to the event loop
+    struct Completion {
+        unsigned long long id;
+        std::string response;
+        bool batch;                     // Ran on batchWorkers_
+    };
+    
+    // Port to listen on and pending-connection queue length
     int port_;
+    int backlog_;
     
     // Flag to track if server is running
-    bool isRunning_;
+    std::atomic<bool> isRunning_;
     
     // Server thread
     std::thread serverThread_;
     
+    // Event loop state, owned by the server thread
+    int listenFd_;
+    int epollFd_;
+    int wakeFd_;                        // eventfd: stop() and finished requests wake the loop
+    unsigned long long nextId_;
+    std::unordered_map<unsigned long long, Connection> connections_;
+    std::unordered_map<std::string, std::vector<unsigned long long>> subscribers_;  // Event streams per session
+    std::string events_;                // publishMessages() buffer, kept to reuse its capacity
+    
+    // Runs the callbacks one request at a time, in arrival order
+    std::unique_ptr<ThreadPool> worker_;
+    std::mutex completionMutex_;
+    std::vector<Completion> completions_;
+    
+    // Batches run until their deadline, so they have workers of their own
+    // and never hold up the puzzle requests of other sessions
+    std::unique_ptr<ThreadPool> batchWorkers_;
+    int pendingBatches_;                // Queued or running; loop thread only
+    
     // Mutex for thread safety
     std::mutex mutex_;
     
-    // Queue of messages to send to clients
-    std::queue<std::string> messageQueue_;
+    SolveJobs* jobs_;
+    
+    // Queue of messages to send to the clients of each session: pushed to
+    // its /api/events subscribers, or kept for /api/messages while there
+    // are none
+    LruCache<std::queue<std::string>> messageQueues_;
+    std::vector<std::string> updatedSessions_;  // Sessions sent a message since the last publish
     
     // Callbacks
-    std::function<void(const std::vector<std::vector<int>>& puzzle)> onPuzzleReceived_;
-    std::function<void()> onSolveRequested_;
-    std::function<void(const std::string& filename, const std::string& content)> onFileUploaded_;
+    std::function<void(const std::string& session, const std::vector<std::vector<int>>& puzzle)> onPuzzleReceived_;
+    std::function<long long(const std::string& session)> onSolveRequested_;
+    std::function<void(const std::string& session, int limit)> onCountRequested_;
+    std::function<void(const std::string& session, const std::string& filename, const std::string& content)> onFileUploaded_;
+    std::function<void(const std::vector<std::string>& lines, std::chrono::milliseconds timeout, std::string& output)> onBatchRequested_;
     
     // Server thread function
     void serverLoop();
     
+    bool openListener();
+    void acceptConnections();
+    void readFromConnection(Connection& connection);
+    void processRequests(Connection& connection);
+    void finishRequest(Connection& connection, const std::string& response);
+    void writeToConnection(Connection& connection);
+    void updateInterest(Connection& connection);
+    void closeConnection(Connection& connection);
+    void finishCompletions();
+    void runOnWorker(ThreadPool& pool, Connection& connection, bool batch);
+    void subscribe(Connection& connection, const std::string& session);
+    void publishMessages();
+    void closeIdleConnections();
+    void wake();
+    void pushMessage(const std::string& session, std::string message);
+    
     // Handle HTTP requests
-    std::string handleRequest(const std::string& request);
+    std::string handleRequest(const HttpRequest& request);
+    std::string handleJobRequest(const HttpRequest& request, std::string_view path, const std::string& session);
+    std::string handleBatchRequest(const HttpRequest& request);
     
     // Convert Sudoku graph to JSON string
     std::string sudokuGraphToJson(const Graph& sudokuGraph, bool isSolution);
+    
+    // Convert a job status to JSON; withType adds "type":"job" for messages
+    std::string jobStatusToJson(const SolveJobs::Status& status, bool withType);
 };
 
 #endif // SUDOKU_GUI_IPC_H 
\ No newline at end of file
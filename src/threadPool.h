@@ -0,0 +1,62 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with per-worker deques and work stealing.
+//
+// Tasks submitted from outside the pool are spread round-robin over the
+// workers; tasks submitted by a worker go to its own deque. A worker pops
+// its newest task first and, when its deque is empty, steals the oldest
+// task of another worker. Every task receives the index of the worker that
+// runs it, so callers can keep per-worker state (graphs, stacks, ...).
+class ThreadPool {
+public:
+    typedef std::function<void(int worker)> Task;
+
+    explicit ThreadPool(int threadCount = 0);   // 0 = one per hardware thread
+    ~ThreadPool();
+
+    void submit(Task task);
+
+    // Block until every submitted task has finished
+    void wait();
+
+    int getThreadCount() const;
+
+    // Index of the calling worker of this pool, -1 for other threads
+    int currentWorker() const;
+
+private:
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;     // Signalled when work arrives or on shutdown
+    std::condition_variable idle;       // Signalled when the last task finishes
+    std::atomic<int> queued;            // Tasks sitting in the deques
+    std::atomic<int> unfinished;        // Tasks submitted but not yet finished
+    std::atomic<unsigned> nextWorker;
+    bool stopping;
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void run(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int index, Task& task);
+};
+
+#endif